@@ -1,3 +1,5 @@
+import os
+import hashlib
 import numpy as np
 import pandas as pd
 import matplotlib.pyplot as plt
@@ -28,7 +30,29 @@ options = [
     ['logx', 'logy'],
 ]
 
+# figures are replotted only when the summary csv or the plot options changed
+manifest_path = dirpath_figure + 'manifest.csv'
+
+manifest = {}
+if os.path.exists(manifest_path):
+    with open(manifest_path) as f:
+        for line in f:
+            name, _, digest = line.strip().partition(',')
+            manifest[name] = digest
+
+def input_digest(target, option):
+    with open(dirpath_summary + target + suffix_summary, 'rb') as f:
+        digest = hashlib.sha256(f.read())
+    digest.update(repr(option).encode())
+    return digest.hexdigest()
+
 for target, option in zip(targets, options):
+    digest = input_digest(target, option)
+
+    if manifest.get(target) == digest and os.path.exists(dirpath_figure + target + suffix_figure):
+        print('up to date: ' + target)
+        continue
+
     data = pd.read_csv(dirpath_summary + target + suffix_summary) 
 
     x, y, err = data['x'], data['y_actual'], data['error(rate)']
@@ -58,4 +82,10 @@ for target, option in zip(targets, options):
     ax2.set_yscale('log')
 
     plt.savefig(dirpath_figure + target + suffix_figure, bbox_inches='tight')
+    plt.close('all')
+
+    manifest[target] = digest
 
+    with open(manifest_path, 'w') as f:
+        for name, value in manifest.items():
+            f.write(name + ',' + value + '\n')
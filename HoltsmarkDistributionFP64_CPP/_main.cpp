@@ -1,29 +1,40 @@
 ﻿#include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <filesystem>
+#include <cstdint>
+#include <cstring>
 #include "holtsmark_distribution.hpp"
+#include "holtsmark_parallel.hpp"
+#include "holtsmark_autotune.hpp"
+#include "holtsmark_manifest.hpp"
 
-void plot_pdf(std::string filepath) {
+void plot_pdf(std::string filepath, double xmin, double xmax, double h) {
     ofstream ofs(filepath);
 
     ofs << "x,pdf" << std::endl;
     ofs << std::scientific << std::setprecision(16);
 
-    for (double x = -6; x <= 64; x += 1. / 1024) {
+    for (double x = xmin; x <= xmax; x += h) {
         ofs << x << ',' << holtsmark_pdf(x) << std::endl;
     }
 
     ofs.close();
 }
 
-void plot_pdf_limit(std::string filepath) {
+void plot_pdf_limit(std::string filepath, double x0min, double x0max, double divs) {
     ofstream ofs(filepath);
 
     ofs << "x,pdf" << std::endl;
     ofs << std::scientific << std::setprecision(16);
 
-    for (double x0 = 64; x0 <= ldexp(1, 64); x0 *= 2) {
-        for (double x = x0; x < x0 * 2; x += x0 / 256) {
+    for (double x0 = x0min; x0 <= x0max; x0 *= 2) {
+        for (double x = x0; x < x0 * 2; x += x0 / divs) {
             ofs << x << ',' << holtsmark_pdf(x) << std::endl;
         }
     }
@@ -31,27 +42,27 @@ void plot_pdf_limit(std::string filepath) {
     ofs.close();
 }
 
-void plot_cdf(std::string filepath) {
+void plot_cdf(std::string filepath, double xmin, double xmax, double h) {
     ofstream ofs(filepath);
 
     ofs << "x,cdf,ccdf" << std::endl;
     ofs << std::scientific << std::setprecision(16);
 
-    for (double x = -6; x <= 64; x += 1. / 1024) {
+    for (double x = xmin; x <= xmax; x += h) {
         ofs << x << ',' << holtsmark_cdf(x) << ',' << holtsmark_cdf(x, true) << std::endl;
     }
 
     ofs.close();
 }
 
-void plot_cdf_limit(std::string filepath) {
+void plot_cdf_limit(std::string filepath, double x0min, double x0max, double divs) {
     ofstream ofs(filepath);
 
     ofs << "x,ccdf" << std::endl;
     ofs << std::scientific << std::setprecision(16);
 
-    for (double x0 = 64; x0 <= ldexp(1, 64); x0 *= 2) {
-        for (double x = x0; x < x0 * 2; x += x0 / 256) {
+    for (double x0 = x0min; x0 <= x0max; x0 *= 2) {
+        for (double x = x0; x < x0 * 2; x += x0 / divs) {
             ofs << x << ',' << holtsmark_cdf(x, true) << std::endl;
         }
     }
@@ -59,40 +70,40 @@ void plot_cdf_limit(std::string filepath) {
     ofs.close();
 }
 
-void plot_quantile(std::string filepath) {
+void plot_quantile(std::string filepath, double h) {
     ofstream ofs(filepath);
 
     ofs << "x,quantile" << std::endl;
     ofs << std::scientific << std::setprecision(16);
 
-    for (double x = 1. / 8192; x < 1; x += 1. / 8192) {
+    for (double x = h; x < 1; x += h) {
         ofs << x << ',' << holtsmark_quantile(x) << std::endl;
     }
 
     ofs.close();
 }
 
-void plot_quantilelower_limit(std::string filepath) {
+void plot_quantilelower_limit(std::string filepath, double xmax, double xmin) {
     ofstream ofs(filepath);
 
     ofs << "x,quantile" << std::endl;
     ofs << std::scientific << std::setprecision(16);
 
-    for (double x = 1. / 8192; x > ldexp(1, -1000); x /= 2) {
+    for (double x = xmax; x > xmin; x /= 2) {
         ofs << x << ',' << holtsmark_quantile(x) << std::endl;
     }
 
     ofs.close();
 }
 
-void plot_quantileupper_limit(std::string filepath) {
+void plot_quantileupper_limit(std::string filepath, double x0max, double x0min, double divs) {
     ofstream ofs(filepath);
 
     ofs << "x,cquantile" << std::endl;
     ofs << std::scientific << std::setprecision(16);
 
-    for (double x0 = 1. / 8192; x0 > ldexp(1, -128); x0 /= 2) {
-        for (double x = x0; x > x0 / 2; x -= x0 / 256) {
+    for (double x0 = x0max; x0 > x0min; x0 /= 2) {
+        for (double x = x0; x > x0 / 2; x -= x0 / divs) {
             ofs << x << ',' << holtsmark_quantile(x, true) << std::endl;
         }
     }
@@ -100,14 +111,102 @@ void plot_quantileupper_limit(std::string filepath) {
     ofs.close();
 }
 
-int main() {
-    plot_pdf("../results/holtsmark_pdf_cpp.csv");
-    plot_pdf_limit("../results/holtsmark_pdf_limit_cpp.csv");
-    plot_cdf("../results/holtsmark_cdf_cpp.csv");
-    plot_cdf_limit("../results/holtsmark_cdf_limit_cpp.csv");
-    plot_quantile("../results/holtsmark_quantile_cpp.csv");
-    plot_quantilelower_limit("../results/holtsmark_quantilelower_limit_cpp.csv");
-    plot_quantileupper_limit("../results/holtsmark_quantileupper_limit_cpp.csv");
+struct dataset {
+    std::string filepath;
+    std::vector<double> grid;
+    std::function<std::vector<double>()> fingerprint;
+    std::function<void(std::string, const std::vector<double>&)> plot;
+};
+
+int main(int argc, char** argv) {
+    // HoltsmarkDistributionFP64_CPP --autotune [header path], default next to holtsmark_autotune.hpp
+    if (argc >= 2 && std::strcmp(argv[1], "--autotune") == 0) {
+        std::filesystem::path expected = holtsmark_tuning_header_path();
+
+        // a relative default would resolve against the working directory, not the build directory
+        if (argc < 3 && expected.is_relative()) {
+            std::cout << "header directory unknown in this build, pass the path of "
+                << "holtsmark_tuning.hpp next to holtsmark_autotune.hpp or define HOLTSMARK_TUNING_DIR" << std::endl;
+            return 1;
+        }
+
+        std::filesystem::path header = (argc >= 3) ? std::filesystem::path(argv[2]) : expected;
+
+        holtsmark_tuning tuning = holtsmark_autotune(1 << 16, 5, &std::cout);
+        holtsmark_write_tuning_header(header.string(), tuning);
+
+        std::cout << "written: " << std::filesystem::absolute(header).string() << std::endl;
+
+        if (expected.is_absolute() && std::filesystem::weakly_canonical(header) != std::filesystem::weakly_canonical(expected)) {
+            std::cout << "note: the build picks up " << expected.string() << std::endl;
+        }
+
+        return 0;
+    }
+
+    const std::string manifest_path = "../results/manifest_cpp.csv";
+
+    auto pdf = []() { return fingerprint_x([](double x) { return holtsmark_pdf(x); }); };
+    auto cdf = []() {
+        std::vector<double> values = fingerprint_x([](double x) { return holtsmark_cdf(x); });
+        std::vector<double> cvalues = fingerprint_x([](double x) { return holtsmark_cdf(x, true); });
+        values.insert(values.end(), cvalues.begin(), cvalues.end());
+        return values;
+    };
+    auto quantile = []() {
+        std::vector<double> values = fingerprint_p([](double p) { return holtsmark_quantile(p); });
+        std::vector<double> cvalues = fingerprint_p([](double p) { return holtsmark_quantile(p, true); });
+        values.insert(values.end(), cvalues.begin(), cvalues.end());
+        return values;
+    };
+
+    std::vector<dataset> datasets = {
+        { "../results/holtsmark_pdf_cpp.csv", { -6, 64, 1. / 1024 }, pdf,
+            [](std::string path, const std::vector<double>& g) { plot_pdf(path, g[0], g[1], g[2]); } },
+        { "../results/holtsmark_pdf_limit_cpp.csv", { 64, ldexp(1, 64), 256 }, pdf,
+            [](std::string path, const std::vector<double>& g) { plot_pdf_limit(path, g[0], g[1], g[2]); } },
+        { "../results/holtsmark_cdf_cpp.csv", { -6, 64, 1. / 1024 }, cdf,
+            [](std::string path, const std::vector<double>& g) { plot_cdf(path, g[0], g[1], g[2]); } },
+        { "../results/holtsmark_cdf_limit_cpp.csv", { 64, ldexp(1, 64), 256 }, cdf,
+            [](std::string path, const std::vector<double>& g) { plot_cdf_limit(path, g[0], g[1], g[2]); } },
+        { "../results/holtsmark_quantile_cpp.csv", { 1. / 8192 }, quantile,
+            [](std::string path, const std::vector<double>& g) { plot_quantile(path, g[0]); } },
+        { "../results/holtsmark_quantilelower_limit_cpp.csv", { 1. / 8192, ldexp(1, -1000) }, quantile,
+            [](std::string path, const std::vector<double>& g) { plot_quantilelower_limit(path, g[0], g[1]); } },
+        { "../results/holtsmark_quantileupper_limit_cpp.csv", { 1. / 8192, ldexp(1, -128), 256 }, quantile,
+            [](std::string path, const std::vector<double>& g) { plot_quantileupper_limit(path, g[0], g[1], g[2]); } },
+    };
+
+    std::map<std::string, std::string> manifest = read_manifest(manifest_path);
+
+    std::vector<std::string> hashes(datasets.size());
+    std::vector<size_t> stale;
+
+    for (size_t i = 0; i < datasets.size(); i++) {
+        hashes[i] = dataset_hash(datasets[i].grid, datasets[i].fingerprint());
+
+        if (manifest_stale(manifest, datasets[i].filepath, hashes[i])) {
+            stale.push_back(i);
+        }
+        else {
+            std::cout << "up to date: " << datasets[i].filepath << std::endl;
+        }
+    }
+
+    parallel_for(stale.size(), [&](size_t j) {
+        const dataset& d = datasets[stale[j]];
+
+        d.plot(d.filepath, d.grid);
+    });
+
+    for (size_t i = 0; i < datasets.size(); i++) {
+        manifest[datasets[i].filepath] = hashes[i];
+    }
+    write_manifest(manifest_path, manifest);
+
+    for (size_t i : stale) {
+        std::cout << "generated: " << datasets[i].filepath << std::endl;
+    }
 
     std::cout << "END" << std::endl;
 }
\ No newline at end of file
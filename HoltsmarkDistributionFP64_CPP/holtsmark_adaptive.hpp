@@ -0,0 +1,250 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// adaptive precision: a cheap tier that reports a relative error bound per point,
+// points whose bound exceeds the tolerance are compacted and re-evaluated by the double kernels.
+// the cheap tier splits each segment of |x| <= 64 into equal cells holding a quintic interpolant at
+// the chebyshev nodes of the cell (<= ~5e-10 relative), the bound of a cell is twice the largest
+// error sampled against the double kernel at table construction.
+// |x| > 64 and nan always escalate.
+
+#pragma once
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <bit>
+#include <cassert>
+#include <numbers>
+#include <algorithm>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_batch.hpp"
+
+using namespace std;
+using namespace std::numbers;
+
+// cells per segment and interpolant degree
+const size_t holtsmark_fast_cells = 32;
+const size_t holtsmark_fast_degree = 5;
+
+struct fast_cell {
+    // polynomial in s = position in cell - 1/2, relative error bound
+    array<double, holtsmark_fast_degree + 1> coef;
+    double bound;
+};
+
+struct fast_table {
+    // per segment
+    vector<double> lower, scale;
+    vector<fast_cell> cells;
+};
+
+double fast_cell_poly(const fast_cell& cell, double s) {
+    double p = cell.coef[holtsmark_fast_degree];
+
+    for (int j = (int)holtsmark_fast_degree - 1; j >= 0; j--) {
+        p = p * s + cell.coef[j];
+    }
+
+    return p;
+}
+
+// cells of segments[0, limit_index), f: exact value on |x|
+template <class Func>
+fast_table to_fast_table(const vector<pade_segment>& segments, int limit_index, Func f) {
+    const size_t n = holtsmark_fast_degree + 1, samples = 64;
+
+    fast_table table;
+
+    for (int index = 0; index < limit_index; index++) {
+        double lower = segments[index].offset, upper = segments[index + 1].offset;
+        double width = (upper - lower) / (double)holtsmark_fast_cells;
+
+        table.lower.push_back(lower);
+        table.scale.push_back((double)holtsmark_fast_cells / (upper - lower));
+
+        for (size_t k = 0; k < holtsmark_fast_cells; k++) {
+            double center = lower + ((double)k + 0.5) * width;
+
+            // chebyshev coefficients in t = 2 s
+            array<double, holtsmark_fast_degree + 1> a{};
+            for (size_t j = 0; j < n; j++) {
+                double theta = (double)(2 * j + 1) * pi / (double)(2 * n);
+                double fj = f(center + 0.5 * width * cos(theta));
+
+                for (size_t m = 0; m < n; m++) {
+                    a[m] += 2 * fj * cos((double)m * theta) / (double)n;
+                }
+            }
+            a[0] *= 0.5;
+
+            // sum a_m T_m(t) to powers of t by the recurrence T_m+1 = 2 t T_m - T_m-1, then t = 2 s
+            fast_cell cell{};
+            array<double, holtsmark_fast_degree + 1> t0{}, t1{}, t2{};
+            t0[0] = 1;
+            t1[1] = 1;
+            for (size_t m = 0; m < n; m++) {
+                const array<double, holtsmark_fast_degree + 1>& tm = (m == 0) ? t0 : t1;
+
+                for (size_t j = 0; j < n; j++) {
+                    cell.coef[j] += a[m] * tm[j];
+                }
+
+                if (m >= 1) {
+                    for (size_t j = 0; j < n; j++) {
+                        t2[j] = ((j > 0) ? 2 * t1[j - 1] : 0) - t0[j];
+                    }
+                    t0 = t1;
+                    t1 = t2;
+                }
+            }
+            for (size_t j = 0; j < n; j++) {
+                cell.coef[j] = ldexp(cell.coef[j], (int)j);
+            }
+
+            double err = 0;
+            for (size_t i = 0; i <= samples; i++) {
+                double s = (double)i / (double)samples - 0.5, expected = f(center + s * width);
+
+                err = max(err, abs(fast_cell_poly(cell, s) - expected) / expected);
+            }
+            cell.bound = 2 * err + 0x1p-51;
+
+            table.cells.push_back(cell);
+        }
+    }
+
+    return table;
+}
+
+const fast_table& holtsmark_pdf_fast_table() {
+    static const fast_table table = to_fast_table(holtsmark_pdf_segments(), holtsmark_pdf_limit_index,
+        [](double x) { return holtsmark_pdf(x); });
+
+    return table;
+}
+
+// tail probability cdf(-|x|), the value before the inversion
+const fast_table& holtsmark_cdf_fast_table() {
+    static const fast_table table = to_fast_table(holtsmark_cdf_segments(), holtsmark_cdf_limit_index,
+        [](double x) { return holtsmark_cdf(-x); });
+
+    return table;
+}
+
+double fast_eval(const fast_table& table, int index, double x, double& bound) {
+    double v = (x - table.lower[index]) * table.scale[index];
+    size_t k = min((size_t)v, holtsmark_fast_cells - 1);
+
+    const fast_cell& cell = table.cells[(size_t)index * holtsmark_fast_cells + k];
+
+    bound = cell.bound;
+
+    return fast_cell_poly(cell, v - ((double)k + 0.5));
+}
+
+// the segment indexes below are holtsmark_pdf/cdf_segment_index for |x| <= 64 without branches,
+// random signs and magnitudes would otherwise mispredict on every point
+
+double holtsmark_pdf_fast(double x, double& bound) {
+    x = abs(x);
+
+    if (!(x <= 64)) {
+        bound = numeric_limits<double>::infinity();
+        return 0;
+    }
+
+    return fast_eval(holtsmark_pdf_fast_table(), max(0, exponent_ceil(x)), x, bound);
+}
+
+double holtsmark_cdf_fast(double x, double& bound, bool complementary = false) {
+    bool inversion = (x <= 0) ^ complementary;
+
+    x = abs(x);
+
+    if (!(x <= 64)) {
+        bound = numeric_limits<double>::infinity();
+        return 0;
+    }
+
+    double y = fast_eval(holtsmark_cdf_fast_table(), max(0, exponent_ceil(x) + 1), x, bound);
+
+    // y <= 1/2, so 1 - y scales the relative error by y / (1 - y) <= 1 and adds one rounding
+    // y or 1 - y by masks, gcc turns a select on the sign into a branch
+    uint64_t flip = inversion ? 0 : 1;
+
+    bound += 0x1p-53;
+    y = bit_cast<double>(flip * 0x3FF0000000000000ull) + bit_cast<double>(bit_cast<uint64_t>(y) ^ (flip << 63));
+
+    return y;
+}
+
+// evaluates the fast tier on (x - mu) / c block by block, re-evaluates points with
+// bound > tolerance (or nan) by the exact batch kernel on the standardized values.
+// tolerances below ~1e-10 escalate nearly everything, the double kernels are the most accurate tier here.
+template <class FastFunc, class ExactBatch>
+size_t adaptive_batch(span<const double> x, span<double> y, double tolerance, double mu, double c,
+    FastFunc fast, ExactBatch exact) {
+
+    assert(x.size() == y.size());
+
+    double c_inv = 1 / c;
+
+    size_t escalated = 0;
+
+    size_t indexes[holtsmark_batch_block];
+    double secondary[holtsmark_batch_block];
+
+    for (size_t b0 = 0; b0 < x.size(); b0 += holtsmark_batch_block) {
+        size_t bn = min(x.size() - b0, holtsmark_batch_block), count = 0;
+
+        for (size_t i = 0; i < bn; i++) {
+            double u = (x[b0 + i] - mu) * c_inv, bound;
+            y[b0 + i] = fast(u, bound);
+
+            indexes[count] = i;
+            secondary[count] = u;
+            count += !(bound <= tolerance) ? 1 : 0;
+        }
+
+        exact(span<double>(secondary, count));
+
+        for (size_t k = 0; k < count; k++) {
+            y[b0 + indexes[k]] = secondary[k];
+        }
+
+        escalated += count;
+    }
+
+    return escalated;
+}
+
+// returns the number of escalated points
+size_t holtsmark_pdf_adaptive_batch(span<const double> x, span<double> y, double tolerance, double mu = 0, double c = 1) {
+    double c_inv = 1 / c;
+
+    size_t escalated = adaptive_batch(x, y, tolerance, mu, c,
+        [=](double v, double& bound) { return holtsmark_pdf_fast(v, bound) * c_inv; },
+        [=](span<double> v) {
+            for (double& u : v) {
+                u = holtsmark_pdf(u) * c_inv;
+            }
+        });
+
+    return escalated;
+}
+
+size_t holtsmark_cdf_adaptive_batch(span<const double> x, span<double> y, double tolerance,
+    double mu = 0, double c = 1, bool complementary = false) {
+
+    size_t escalated = adaptive_batch(x, y, tolerance, mu, c,
+        [=](double v, double& bound) { return holtsmark_cdf_fast(v, bound, complementary); },
+        [=](span<double> v) { holtsmark_cdf_batch(v, v, 0, 1, complementary); });
+
+    return escalated;
+}
@@ -0,0 +1,201 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// strategy selection for the batch kernels.
+// holtsmark_autotune benchmarks every strategy on representative inputs of the running machine,
+// holtsmark_write_tuning_header writes the choice to holtsmark_tuning.hpp, which is picked up
+// by the next build. __has_include looks next to this header, not in the working directory of
+// the tuning run, so the file goes to holtsmark_tuning_header_path() by default
+// (HoltsmarkDistributionFP64_CPP --autotune [header path]).
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_bucketed.hpp"
+#include "holtsmark_permute.hpp"
+
+#if __has_include("holtsmark_tuning.hpp")
+#include "holtsmark_tuning.hpp"
+#endif
+
+using namespace std;
+
+// plain: per element kernel, bucketed: segment counting sort, permute: transposed coefficient tables
+enum class holtsmark_strategy {
+    plain = 0, bucketed = 1, permute = 2
+};
+
+#ifndef HOLTSMARK_TUNED_PDF
+#define HOLTSMARK_TUNED_PDF 1
+#endif
+#ifndef HOLTSMARK_TUNED_CDF
+#define HOLTSMARK_TUNED_CDF 1
+#endif
+#ifndef HOLTSMARK_TUNED_QUANTILE
+#define HOLTSMARK_TUNED_QUANTILE 0
+#endif
+
+struct holtsmark_tuning {
+    holtsmark_strategy pdf, cdf, quantile;
+};
+
+holtsmark_tuning& holtsmark_active_tuning() {
+    static holtsmark_tuning tuning = {
+        (holtsmark_strategy)HOLTSMARK_TUNED_PDF,
+        (holtsmark_strategy)HOLTSMARK_TUNED_CDF,
+        (holtsmark_strategy)HOLTSMARK_TUNED_QUANTILE,
+    };
+
+    return tuning;
+}
+
+void holtsmark_pdf_tuned_batch(span<const double> x, span<double> y, double mu = 0, double c = 1) {
+    switch (holtsmark_active_tuning().pdf) {
+    case holtsmark_strategy::bucketed:
+        holtsmark_pdf_bucketed_batch(x, y, mu, c);
+        break;
+    case holtsmark_strategy::permute:
+        holtsmark_pdf_permute_batch(x, y, mu, c);
+        break;
+    default:
+        holtsmark_pdf_batch(x, y, mu, c);
+        break;
+    }
+}
+
+void holtsmark_cdf_tuned_batch(span<const double> x, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+    switch (holtsmark_active_tuning().cdf) {
+    case holtsmark_strategy::bucketed:
+        holtsmark_cdf_bucketed_batch(x, y, mu, c, complementary);
+        break;
+    case holtsmark_strategy::permute:
+        holtsmark_cdf_permute_batch(x, y, mu, c, complementary);
+        break;
+    default:
+        holtsmark_cdf_batch(x, y, mu, c, complementary);
+        break;
+    }
+}
+
+// the quantile has a single kernel so far, the entry exists so that the config format stays stable
+void holtsmark_quantile_tuned_batch(span<const double> p, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+    holtsmark_quantile_batch(p, y, mu, c, complementary);
+}
+
+// seconds per element, best of repeats
+template <class Kernel>
+double autotune_measure(Kernel kernel, span<const double> x, span<double> y, int repeats) {
+    double best = numeric_limits<double>::infinity();
+
+    for (int r = 0; r < repeats; r++) {
+        auto t0 = chrono::steady_clock::now();
+        kernel(x, y);
+        auto t1 = chrono::steady_clock::now();
+
+        best = min(best, chrono::duration<double>(t1 - t0).count());
+    }
+
+    return best / (double)x.size();
+}
+
+// representative inputs: holtsmark variates, the central segments and the far tail
+vector<vector<double>> autotune_inputs(size_t n) {
+    mt19937_64 engine(1234);
+
+    vector<double> variates(n), central(n), tail(n);
+
+    holtsmark_sample_batch(engine, span<double>(variates));
+
+    uniform_real_distribution<double> center(-4, 4), decade(1.8, 6);
+    for (size_t i = 0; i < n; i++) {
+        central[i] = center(engine);
+        tail[i] = ((engine() & 1) ? 1 : -1) * pow(10, decade(engine));
+    }
+
+    return { variates, central, tail };
+}
+
+template <class Kernel>
+double autotune_score(Kernel kernel, const vector<vector<double>>& inputs, int repeats) {
+    double score = 0;
+
+    for (const vector<double>& x : inputs) {
+        vector<double> y(x.size());
+        score += autotune_measure(kernel, x, y, repeats);
+    }
+
+    return score;
+}
+
+holtsmark_tuning holtsmark_autotune(size_t n = 1 << 16, int repeats = 5, ostream* log = nullptr) {
+    vector<vector<double>> inputs = autotune_inputs(n);
+
+    auto choose = [&](const char* name, const vector<pair<holtsmark_strategy, double>>& scores) {
+        auto best = min_element(scores.begin(), scores.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+
+        if (log != nullptr) {
+            for (const auto& [strategy, score] : scores) {
+                *log << name << " strategy " << (int)strategy << ": " << score * 1e9 / (double)inputs.size() << " ns" << endl;
+            }
+        }
+
+        return best->first;
+    };
+
+    holtsmark_tuning tuning;
+
+    tuning.pdf = choose("pdf", {
+        { holtsmark_strategy::plain, autotune_score([](span<const double> x, span<double> y) { holtsmark_pdf_batch(x, y); }, inputs, repeats) },
+        { holtsmark_strategy::bucketed, autotune_score([](span<const double> x, span<double> y) { holtsmark_pdf_bucketed_batch(x, y); }, inputs, repeats) },
+        { holtsmark_strategy::permute, autotune_score([](span<const double> x, span<double> y) { holtsmark_pdf_permute_batch(x, y); }, inputs, repeats) },
+    });
+
+    tuning.cdf = choose("cdf", {
+        { holtsmark_strategy::plain, autotune_score([](span<const double> x, span<double> y) { holtsmark_cdf_batch(x, y); }, inputs, repeats) },
+        { holtsmark_strategy::bucketed, autotune_score([](span<const double> x, span<double> y) { holtsmark_cdf_bucketed_batch(x, y); }, inputs, repeats) },
+        { holtsmark_strategy::permute, autotune_score([](span<const double> x, span<double> y) { holtsmark_cdf_permute_batch(x, y); }, inputs, repeats) },
+    });
+
+    tuning.quantile = holtsmark_strategy::plain;
+
+    return tuning;
+}
+
+// holtsmark_tuning.hpp in the directory of this header, or in HOLTSMARK_TUNING_DIR if defined.
+// __FILE__ is absolute with msvc, with gcc / clang it is relative to the build directory
+// unless the source path is absolute; the result is relative then.
+string holtsmark_tuning_header_path() {
+#ifdef HOLTSMARK_TUNING_DIR
+    filesystem::path dir = HOLTSMARK_TUNING_DIR;
+#else
+    filesystem::path dir = filesystem::path(__FILE__).parent_path();
+#endif
+
+    return (dir / "holtsmark_tuning.hpp").string();
+}
+
+void holtsmark_write_tuning_header(const string& filepath, const holtsmark_tuning& tuning) {
+    ofstream ofs(filepath);
+
+    ofs << "// generated by holtsmark_autotune, strategies: 0 plain, 1 bucketed, 2 permute" << endl;
+    ofs << endl;
+    ofs << "#pragma once" << endl;
+    ofs << endl;
+    ofs << "#define HOLTSMARK_TUNED_PDF " << (int)tuning.pdf << endl;
+    ofs << "#define HOLTSMARK_TUNED_CDF " << (int)tuning.cdf << endl;
+    ofs << "#define HOLTSMARK_TUNED_QUANTILE " << (int)tuning.quantile << endl;
+
+    ofs.close();
+}
@@ -0,0 +1,97 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <numbers>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_reduction.hpp"
+
+using namespace std;
+using namespace std::numbers;
+
+// elements per block, sized so that inputs, outputs and scratch of a block stay in L1
+const size_t holtsmark_batch_block = 1024;
+
+// location-scale batch kernels, y[i] = f((x[i] - mu) / c)
+
+void holtsmark_pdf_batch(span<const double> x, span<double> y, double mu = 0, double c = 1) {
+    assert(x.size() == y.size());
+
+    double c_inv = 1 / c;
+
+    for (size_t i = 0; i < x.size(); i++) {
+        y[i] = holtsmark_pdf((x[i] - mu) * c_inv) * c_inv;
+    }
+}
+
+void holtsmark_logpdf_batch(span<const double> x, span<double> y, double mu = 0, double c = 1) {
+    assert(x.size() == y.size());
+
+    double c_inv = 1 / c, log_c = log(c);
+
+    for (size_t i = 0; i < x.size(); i++) {
+        y[i] = holtsmark_logpdf((x[i] - mu) * c_inv) - log_c;
+    }
+}
+
+void holtsmark_cdf_batch(span<const double> x, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+    assert(x.size() == y.size());
+
+    double c_inv = 1 / c;
+
+    for (size_t i = 0; i < x.size(); i++) {
+        y[i] = holtsmark_cdf((x[i] - mu) * c_inv, complementary);
+    }
+}
+
+void holtsmark_quantile_batch(span<const double> p, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+    assert(p.size() == y.size());
+
+    for (size_t i = 0; i < p.size(); i++) {
+        y[i] = mu + c * holtsmark_quantile(p[i], complementary);
+    }
+}
+
+// uniform in (0, 1) from the upper 53 bits
+double uniform_open01(uint64_t bits) {
+    return ldexp((double)((bits >> 11) | 1u), -53);
+}
+
+// uniform in (0, 1] from the upper 53 bits
+double uniform_open0(uint64_t bits) {
+    return ldexp((double)((bits >> 11) + 1u), -53);
+}
+
+// chambers-mallows-stuck transform, u in (-1/2, 1/2), w in (0, 1]
+double holtsmark_sample_transform(double u, double w) {
+    double cu = cos(pi * u);
+
+    double r = sin(pi * u * 1.5) * cbrt(log(w) / (cos(pi * u * 0.5) * cu * cu));
+
+    return r;
+}
+
+// engine must return uniform 64-bit integers (e.g. mt19937_64)
+template <class Engine>
+void holtsmark_sample_batch(Engine& engine, span<double> y, double mu = 0, double c = 1) {
+    for (size_t i = 0; i < y.size(); i++) {
+        double u = uniform_open01(engine()) - 0.5;
+        double w = uniform_open0(engine());
+
+        y[i] = holtsmark_sample_transform(u, w) * c + mu;
+    }
+}
+
+// sum_i pdf(x[i]; mu, c), reproducible for any thread count
+double holtsmark_pdf_sum(span<const double> x, double mu = 0, double c = 1, size_t threads = 0) {
+    return reproducible_sum(x.size(), [&](size_t i0, span<double> buffer) {
+        holtsmark_pdf_batch(x.subspan(i0, buffer.size()), buffer, mu, c);
+    }, threads);
+}
@@ -0,0 +1,230 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// segment-bucketed batch executor: the elements of a block are counting-sorted by pade segment,
+// every bucket is evaluated by a fixed-degree kernel with the segment coefficients hoisted
+// out of the element loop, and the results are scattered back.
+// results are bit-identical to holtsmark_pdf / holtsmark_cdf.
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_batch.hpp"
+
+using namespace std;
+
+// blocks with fewer elements than this are evaluated element by element
+const size_t holtsmark_bucket_min = 64;
+
+// maximum number of coefficients of the segment polynomials
+const size_t holtsmark_pade_max_terms = 12;
+
+// coefficients padded with zeros up to terms, numerator and denominator alike.
+// leading zeros leave horner exact for finite arguments.
+struct padded_pade_segment {
+    double offset;
+    size_t terms;
+    array<double, holtsmark_pade_max_terms> numer, denom;
+};
+
+vector<padded_pade_segment> to_padded_segments(const vector<pade_segment>& segments) {
+    vector<padded_pade_segment> padded_segments;
+
+    for (const pade_segment& segment : segments) {
+        padded_pade_segment padded{ segment.offset, max(segment.numer.size(), segment.denom.size()), {}, {} };
+
+        assert(padded.terms <= holtsmark_pade_max_terms);
+
+        copy(segment.numer.begin(), segment.numer.end(), padded.numer.begin());
+        copy(segment.denom.begin(), segment.denom.end(), padded.denom.begin());
+
+        padded_segments.push_back(padded);
+    }
+
+    return padded_segments;
+}
+
+const vector<padded_pade_segment>& holtsmark_pdf_padded_segments() {
+    static const vector<padded_pade_segment> segments = to_padded_segments(holtsmark_pdf_segments());
+
+    return segments;
+}
+
+const vector<padded_pade_segment>& holtsmark_cdf_padded_segments() {
+    static const vector<padded_pade_segment> segments = to_padded_segments(holtsmark_cdf_segments());
+
+    return segments;
+}
+
+// y[i] = pade(s[i]) on one segment, the trip count of horner is a compile-time constant
+template <size_t Terms>
+void pade_bucket(const padded_pade_segment& segment, span<const double> s, span<double> y) {
+    double numer[Terms], denom[Terms];
+    copy_n(segment.numer.begin(), Terms, numer);
+    copy_n(segment.denom.begin(), Terms, denom);
+
+    for (size_t i = 0; i < s.size(); i++) {
+        double v = s[i], n = numer[Terms - 1], d = denom[Terms - 1];
+
+        for (size_t j = Terms - 1; j-- > 0;) {
+            n = n * v + numer[j];
+            d = d * v + denom[j];
+        }
+
+        y[i] = n / d;
+    }
+}
+
+void pade_bucket(const padded_pade_segment& segment, span<const double> s, span<double> y) {
+    switch (segment.terms) {
+    case 1: case 2: case 3: case 4:
+        pade_bucket<4>(segment, s, y);
+        break;
+    case 5: case 6:
+        pade_bucket<6>(segment, s, y);
+        break;
+    case 7:
+        pade_bucket<7>(segment, s, y);
+        break;
+    case 8:
+        pade_bucket<8>(segment, s, y);
+        break;
+    case 9:
+        pade_bucket<9>(segment, s, y);
+        break;
+    case 10:
+        pade_bucket<10>(segment, s, y);
+        break;
+    case 11:
+        pade_bucket<11>(segment, s, y);
+        break;
+    default:
+        pade_bucket<holtsmark_pade_max_terms>(segment, s, y);
+        break;
+    }
+}
+
+// v: standardized block, y: pade value of every element, finish(i, a, s, t) returns the final
+// value of element i from |v[i]|, the pade argument s and the pade value t.
+template <class SegmentIndex, class Finish>
+void bucketed_block(const vector<padded_pade_segment>& segments, int limit_index, SegmentIndex segment_index,
+    span<const double> v, span<double> y, Finish finish) {
+
+    const size_t max_segments = 16;
+    assert(segments.size() <= max_segments && v.size() <= holtsmark_batch_block);
+
+    size_t n = v.size();
+
+    uint8_t index[holtsmark_batch_block];
+    uint16_t order[holtsmark_batch_block];
+    double magnitude[holtsmark_batch_block], arg[holtsmark_batch_block], value[holtsmark_batch_block];
+    size_t counts[max_segments] = {}, offsets[max_segments + 1] = {};
+
+    for (size_t i = 0; i < n; i++) {
+        int k = segment_index(v[i]);
+
+        index[i] = (uint8_t)k;
+        counts[k]++;
+    }
+
+    for (size_t k = 0; k < segments.size(); k++) {
+        offsets[k + 1] = offsets[k] + counts[k];
+    }
+
+    size_t cursor[max_segments];
+    copy_n(offsets, segments.size(), cursor);
+
+    for (size_t i = 0; i < n; i++) {
+        int k = index[i];
+        double a = abs(v[i]);
+
+        size_t j = cursor[k]++;
+
+        order[j] = (uint16_t)i;
+        magnitude[j] = a;
+        arg[j] = (k < limit_index) ? a - segments[k].offset : pow_m1p5(a);
+    }
+
+    for (size_t k = 0; k < segments.size(); k++) {
+        size_t j0 = offsets[k], jn = counts[k];
+
+        if (jn > 0) {
+            pade_bucket(segments[k], span<const double>(arg + j0, jn), span<double>(value + j0, jn));
+        }
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        y[order[j]] = finish(order[j], magnitude[j], arg[j], value[j]);
+    }
+}
+
+void holtsmark_pdf_bucketed_batch(span<const double> x, span<double> y, double mu = 0, double c = 1) {
+    assert(x.size() == y.size());
+
+    const vector<padded_pade_segment>& segments = holtsmark_pdf_padded_segments();
+
+    double c_inv = 1 / c;
+    double v[holtsmark_batch_block];
+
+    for (size_t b0 = 0; b0 < x.size(); b0 += holtsmark_batch_block) {
+        size_t bn = min(x.size() - b0, holtsmark_batch_block);
+
+        if (bn < holtsmark_bucket_min) {
+            holtsmark_pdf_batch(x.subspan(b0, bn), y.subspan(b0, bn), mu, c);
+            continue;
+        }
+
+        for (size_t i = 0; i < bn; i++) {
+            v[i] = (x[b0 + i] - mu) * c_inv;
+        }
+
+        bucketed_block(segments, holtsmark_pdf_limit_index, holtsmark_pdf_segment_index,
+            span<const double>(v, bn), y.subspan(b0, bn),
+            [&](size_t, double a, double, double t) {
+                double p = (a <= 64) ? t : t * pow_m2p5(a);
+                return p * c_inv;
+            }
+        );
+    }
+}
+
+void holtsmark_cdf_bucketed_batch(span<const double> x, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+    assert(x.size() == y.size());
+
+    const vector<padded_pade_segment>& segments = holtsmark_cdf_padded_segments();
+
+    double c_inv = 1 / c;
+    double v[holtsmark_batch_block];
+
+    for (size_t b0 = 0; b0 < x.size(); b0 += holtsmark_batch_block) {
+        size_t bn = min(x.size() - b0, holtsmark_batch_block);
+
+        if (bn < holtsmark_bucket_min) {
+            holtsmark_cdf_batch(x.subspan(b0, bn), y.subspan(b0, bn), mu, c, complementary);
+            continue;
+        }
+
+        for (size_t i = 0; i < bn; i++) {
+            v[i] = (x[b0 + i] - mu) * c_inv;
+        }
+
+        bucketed_block(segments, holtsmark_cdf_limit_index, holtsmark_cdf_segment_index,
+            span<const double>(v, bn), y.subspan(b0, bn),
+            [&](size_t i, double a, double s, double t) {
+                bool inversion = (v[i] <= 0) ^ complementary;
+
+                double p = (a <= 64) ? t : t * s;
+                return inversion ? p : 1 - p;
+            }
+        );
+    }
+}
@@ -0,0 +1,208 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// micro-batching of scalar cdf calls from many threads.
+// threads are dealt round-robin over the shards. each shard counts its callers that are not yet
+// answered or taken into a batch; a caller that finds the count zero evaluates directly
+// (lock-free, no future). otherwise it queues and the first caller of an open batch becomes the
+// leader: it polls until every counted caller has queued, the batch is full or the latency
+// window has passed, evaluates the batch with the tuned batch kernel and hands out the results.
+// waiting is by polling with yield, never by a timed sleep, so the window is not stretched by
+// timer slack.
+
+#pragma once
+
+#include <span>
+#include <mutex>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_autotune.hpp"
+#include "holtsmark_parallel.hpp"
+
+using namespace std;
+
+struct holtsmark_coalescer_counters {
+    uint64_t direct = 0, coalesced = 0, batches = 0;
+};
+
+class holtsmark_cdf_coalescer {
+public:
+    explicit holtsmark_cdf_coalescer(chrono::nanoseconds window = chrono::microseconds(2),
+        size_t max_batch = 256, size_t shards = 0)
+        : window(window), max_batch(max_batch) {
+
+        shards = parallel_threads(shards);
+
+        for (size_t i = 0; i < shards; i++) {
+            shard_list.push_back(make_unique<shard>());
+        }
+    }
+
+    // bit-identical to holtsmark_cdf(x, complementary)
+    double operator()(double x, bool complementary = false) {
+        // ccdf(x) = cdf(-x), so one batch serves both tails
+        double v = complementary ? -x : x;
+
+        shard& s = current_shard();
+
+        if (s.pending.fetch_add(1, memory_order_acq_rel) == 0) {
+            double y = holtsmark_cdf(v);
+            s.pending.fetch_sub(1, memory_order_release);
+
+            direct.fetch_add(1, memory_order_relaxed);
+
+            return y;
+        }
+
+        double y;
+        shared_ptr<batch_state> state = join(s, v, &y, nullptr);
+
+        if (state) {
+            for (int spin = 0; !state->ready.load(memory_order_acquire); spin++) {
+                if (spin < 64) {
+                    this_thread::yield();
+                }
+                else {
+                    state->ready.wait(false, memory_order_acquire);
+                }
+            }
+        }
+
+        return y;
+    }
+
+    future<double> submit(double x, bool complementary = false) {
+        double v = complementary ? -x : x;
+
+        shard& s = current_shard();
+
+        promise<double> result;
+        future<double> f = result.get_future();
+
+        if (s.pending.fetch_add(1, memory_order_acq_rel) == 0) {
+            result.set_value(holtsmark_cdf(v));
+            s.pending.fetch_sub(1, memory_order_release);
+
+            direct.fetch_add(1, memory_order_relaxed);
+
+            return f;
+        }
+
+        join(s, v, nullptr, &result);
+
+        return f;
+    }
+
+    holtsmark_coalescer_counters counters() const {
+        return { direct.load(), coalesced.load(), batches.load() };
+    }
+
+private:
+    struct batch_state {
+        atomic<bool> ready = false;
+    };
+
+    struct alignas(64) shard {
+        // callers counted on entry, uncounted when answered directly or taken into a batch
+        atomic<size_t> pending = 0;
+        atomic<size_t> queued = 0;
+
+        mutex m;
+        vector<double> x;
+        vector<double*> out;
+        vector<promise<double>> promises;
+        bool leading = false;
+        shared_ptr<batch_state> state;
+    };
+
+    shard& current_shard() {
+        static atomic<size_t> next_ticket = 0;
+        thread_local size_t ticket = next_ticket.fetch_add(1, memory_order_relaxed);
+
+        return *shard_list[ticket % shard_list.size()];
+    }
+
+    // queues v, the result goes to *out or to the moved-in promise.
+    // returns the batch to wait for, or null if this caller led the batch and out is already written.
+    shared_ptr<batch_state> join(shard& s, double v, double* out, promise<double>* result) {
+        unique_lock<mutex> lock(s.m);
+
+        s.x.push_back(v);
+        s.out.push_back(out);
+        if (result != nullptr) {
+            s.promises.push_back(std::move(*result));
+        }
+        s.queued.store(s.x.size(), memory_order_release);
+
+        if (s.leading) {
+            return s.state;
+        }
+
+        s.leading = true;
+        s.state = make_shared<batch_state>();
+
+        lock.unlock();
+
+        auto deadline = chrono::steady_clock::now() + window;
+
+        for (int spin = 0; ; spin++) {
+            size_t queued = s.queued.load(memory_order_acquire);
+
+            if (queued >= max_batch || queued >= s.pending.load(memory_order_acquire)) {
+                break;
+            }
+            if ((spin & 15) == 15 && chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+
+            this_thread::yield();
+        }
+
+        lock.lock();
+
+        vector<double> batch;
+        vector<double*> outs;
+        vector<promise<double>> promises;
+        swap(batch, s.x);
+        swap(outs, s.out);
+        swap(promises, s.promises);
+        shared_ptr<batch_state> state = std::move(s.state);
+        s.leading = false;
+        s.queued.store(0, memory_order_relaxed);
+        s.pending.fetch_sub(batch.size(), memory_order_release);
+
+        lock.unlock();
+
+        vector<double> y(batch.size());
+        holtsmark_cdf_tuned_batch(batch, y);
+
+        for (size_t i = 0, k = 0; i < batch.size(); i++) {
+            if (outs[i] != nullptr) {
+                *outs[i] = y[i];
+            }
+            else {
+                promises[k++].set_value(y[i]);
+            }
+        }
+
+        state->ready.store(true, memory_order_release);
+        state->ready.notify_all();
+
+        coalesced.fetch_add(batch.size(), memory_order_relaxed);
+        batches.fetch_add(1, memory_order_relaxed);
+
+        return nullptr;
+    }
+
+    chrono::nanoseconds window;
+    size_t max_batch;
+    vector<unique_ptr<shard>> shard_list;
+    atomic<uint64_t> direct = 0, coalesced = 0, batches = 0;
+};
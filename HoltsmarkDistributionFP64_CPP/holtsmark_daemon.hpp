@@ -0,0 +1,554 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// evaluation daemon over a unix domain socket (POSIX only).
+//
+// protocol, native byte order, every message is a fixed header followed by doubles:
+//   request : holtsmark_daemon_request  (32 bytes) + count doubles (none for sample and stats)
+//   response: holtsmark_daemon_response (8 bytes)  + count doubles
+// requests on one connection are answered in order.
+// writes never raise SIGPIPE: a client closing its socket early only drops its own connection.
+// pending requests of all connections are coalesced per operation into one standardized
+// batch, which is split into blocks and evaluated on a persistent parallel_pool.
+// a connection whose queued responses exceed output_high_water is not read from, and no more of
+// its requests are parsed, until the client has drained it below the mark.
+
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <vector>
+#include <span>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <random>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_parallel.hpp"
+
+using namespace std;
+
+#if defined(MSG_NOSIGNAL)
+const int holtsmark_daemon_send_flags = MSG_NOSIGNAL;
+#else
+const int holtsmark_daemon_send_flags = 0;
+#endif
+
+// send without SIGPIPE on a peer that has gone away, EPIPE is returned instead.
+// platforms without MSG_NOSIGNAL set SO_NOSIGPIPE on the socket (holtsmark_daemon_nosigpipe).
+ssize_t holtsmark_daemon_send(int fd, const void* data, size_t bytes) {
+    ssize_t n;
+    do {
+        n = send(fd, data, bytes, holtsmark_daemon_send_flags);
+    } while (n < 0 && errno == EINTR);
+
+    return n;
+}
+
+void holtsmark_daemon_nosigpipe([[maybe_unused]] int fd) {
+#if defined(SO_NOSIGPIPE)
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+enum holtsmark_daemon_op : uint8_t {
+    holtsmark_daemon_pdf = 1,
+    holtsmark_daemon_cdf = 2,
+    holtsmark_daemon_quantile = 3,
+    holtsmark_daemon_sample = 4,
+    holtsmark_daemon_stats = 15,
+};
+
+enum holtsmark_daemon_status : uint32_t {
+    holtsmark_daemon_ok = 0,
+    holtsmark_daemon_bad_request = 1,
+};
+
+struct holtsmark_daemon_request {
+    uint8_t op;
+    uint8_t complementary;
+    uint16_t reserved;
+    uint32_t count;
+    double mu, c;
+    uint64_t seed;
+};
+
+struct holtsmark_daemon_response {
+    uint32_t status;
+    uint32_t count;
+};
+
+static_assert(sizeof(holtsmark_daemon_request) == 32);
+static_assert(sizeof(holtsmark_daemon_response) == 8);
+
+// returned by the stats operation in this order, as doubles
+struct holtsmark_daemon_counters {
+    uint64_t requests, elements, batches;
+    uint64_t latency_total_ns, latency_max_ns;
+    uint64_t uptime_ns;
+};
+
+class holtsmark_daemon {
+public:
+    // elements per parallel task of a coalesced batch
+    static const size_t task_elements = 16 * holtsmark_batch_block;
+    static const uint32_t max_count = 1u << 24;
+    // queued response bytes per connection above which its requests wait
+    static const size_t output_high_water = 1u << 24;
+
+    holtsmark_daemon(string path, size_t threads = 0) : path(path), pool(threads) {
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0) {
+            throw runtime_error("holtsmark_daemon: socket failed");
+        }
+
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            close(listener);
+            throw invalid_argument("holtsmark_daemon: socket path too long");
+        }
+        strcpy(addr.sun_path, path.c_str());
+
+        unlink(path.c_str());
+        if (bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 64) < 0) {
+            close(listener);
+            throw runtime_error("holtsmark_daemon: bind failed");
+        }
+
+        fcntl(listener, F_SETFL, O_NONBLOCK);
+
+        started = chrono::steady_clock::now();
+    }
+
+    ~holtsmark_daemon() {
+        for (connection& conn : connections) {
+            close(conn.fd);
+        }
+        close(listener);
+        unlink(path.c_str());
+    }
+
+    holtsmark_daemon(const holtsmark_daemon&) = delete;
+    holtsmark_daemon& operator=(const holtsmark_daemon&) = delete;
+
+    // serves until stop() is called from another thread
+    void run() {
+        while (!stopping.load(memory_order_relaxed)) {
+            poll_once(100);
+        }
+    }
+
+    void stop() {
+        stopping.store(true, memory_order_relaxed);
+    }
+
+    holtsmark_daemon_counters counters() const {
+        return holtsmark_daemon_counters{
+            requests.load(memory_order_relaxed),
+            elements.load(memory_order_relaxed),
+            batches.load(memory_order_relaxed),
+            latency_total_ns.load(memory_order_relaxed),
+            latency_max_ns.load(memory_order_relaxed),
+            (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - started).count()
+        };
+    }
+
+    // response bytes queued for slow readers over all connections.
+    // not synchronized with run(), for callers driving poll_once themselves
+    size_t queued_bytes() const {
+        size_t bytes = 0;
+        for (const connection& conn : connections) {
+            bytes += conn.output.size();
+        }
+        return bytes;
+    }
+
+    // one poll round: accept, read every complete request, evaluate them coalesced, queue the responses
+    void poll_once(int timeout_ms) {
+        vector<pollfd> fds(connections.size() + 1);
+
+        fds[0] = pollfd{ listener, POLLIN, 0 };
+        for (size_t i = 0; i < connections.size(); i++) {
+            const connection& conn = connections[i];
+
+            bool readable = conn.output.size() < output_high_water && conn.input.size() < max_request_bytes;
+
+            fds[i + 1] = pollfd{ conn.fd, (short)((readable ? POLLIN : 0) | (conn.output.empty() ? 0 : POLLOUT)), 0 };
+
+            // requests held back by the high-water mark are parsed without waiting for new input
+            if (conn.held && conn.output.size() < output_high_water) {
+                timeout_ms = 0;
+            }
+        }
+
+        if (poll(fds.data(), fds.size(), timeout_ms) < 0) {
+            return;
+        }
+
+        vector<pending> batch;
+
+        for (size_t i = 0; i < connections.size(); i++) {
+            // a hung up peer with queued output fails the send and is dropped
+            if ((fds[i + 1].revents & (POLLOUT | POLLHUP | POLLERR)) && !connections[i].output.empty()) {
+                flush(connections[i]);
+            }
+            if ((fds[i + 1].events & POLLIN) && (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) {
+                receive(connections[i]);
+            }
+            parse(connections[i], batch);
+        }
+
+        if (fds[0].revents & POLLIN) {
+            accept_all();
+        }
+
+        if (!batch.empty()) {
+            evaluate(batch);
+            respond(batch);
+        }
+
+        erase_if(connections, [](const connection& conn) {
+            if (conn.closed && conn.output.empty()) {
+                close(conn.fd);
+                return true;
+            }
+            return false;
+        });
+    }
+
+private:
+    struct connection {
+        int fd;
+        vector<uint8_t> input, output;
+        // closed: no more input, broken: the peer is gone and nothing more is written,
+        // held: complete requests were left in input by the high-water mark
+        bool closed = false, broken = false, held = false;
+    };
+
+    struct pending {
+        int fd;
+        holtsmark_daemon_request request;
+        vector<double> values;
+        holtsmark_daemon_status status = holtsmark_daemon_ok;
+        chrono::steady_clock::time_point received;
+    };
+
+    static const size_t max_request_bytes = sizeof(holtsmark_daemon_request) + max_count * sizeof(double);
+
+    string path;
+    parallel_pool pool;
+    int listener;
+    vector<connection> connections;
+    atomic<bool> stopping = false;
+    chrono::steady_clock::time_point started;
+
+    atomic<uint64_t> requests = 0, elements = 0, batches = 0;
+    atomic<uint64_t> latency_total_ns = 0, latency_max_ns = 0;
+
+    void accept_all() {
+        int fd;
+        while ((fd = accept(listener, nullptr, nullptr)) >= 0) {
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+            holtsmark_daemon_nosigpipe(fd);
+            connection conn;
+            conn.fd = fd;
+            connections.push_back(move(conn));
+        }
+    }
+
+    // reads what has arrived, up to one largest request
+    void receive(connection& conn) {
+        uint8_t buffer[65536];
+        ssize_t n = 0;
+        while (conn.input.size() < max_request_bytes && (n = read(conn.fd, buffer, sizeof(buffer))) > 0) {
+            conn.input.insert(conn.input.end(), buffer, buffer + n);
+        }
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            conn.closed = true;
+        }
+    }
+
+    // moves complete requests into the batch while the queued responses stay below the mark
+    void parse(connection& conn, vector<pending>& batch) {
+        if (conn.broken) {
+            return;
+        }
+
+        size_t offset = 0, queued = conn.output.size();
+        while (queued < output_high_water && conn.input.size() - offset >= sizeof(holtsmark_daemon_request)) {
+            holtsmark_daemon_request request;
+            memcpy(&request, conn.input.data() + offset, sizeof(request));
+
+            bool has_input = request.op != holtsmark_daemon_sample && request.op != holtsmark_daemon_stats;
+            size_t bytes = sizeof(request) + (has_input ? request.count * sizeof(double) : 0);
+
+            if (request.count > max_count) {
+                conn.closed = true;
+                conn.held = false;
+                conn.input.clear();
+                return;
+            }
+            if (conn.input.size() - offset < bytes) {
+                break;
+            }
+
+            pending item;
+            item.fd = conn.fd;
+            item.request = request;
+            item.values.resize(request.count);
+            item.received = chrono::steady_clock::now();
+
+            if (has_input) {
+                memcpy(item.values.data(), conn.input.data() + offset + sizeof(request), request.count * sizeof(double));
+            }
+
+            batch.push_back(move(item));
+            offset += bytes;
+            queued += sizeof(holtsmark_daemon_response)
+                + (request.op == holtsmark_daemon_stats ? 6 : request.count) * sizeof(double);
+        }
+
+        conn.input.erase(conn.input.begin(), conn.input.begin() + offset);
+        conn.held = queued >= output_high_water && conn.input.size() >= sizeof(holtsmark_daemon_request);
+    }
+
+    // concatenates standardized inputs of one operation, evaluates them in parallel blocks and scatters back
+    void evaluate_coalesced(vector<pending*>& items, uint8_t op, bool complementary) {
+        vector<double> values;
+        for (pending* item : items) {
+            const holtsmark_daemon_request& request = item->request;
+
+            for (double x : item->values) {
+                values.push_back(op == holtsmark_daemon_quantile ? x : (x - request.mu) / request.c);
+            }
+        }
+
+        size_t tasks = (values.size() + task_elements - 1) / task_elements;
+
+        parallel_for(tasks, [&](size_t task) {
+            size_t i0 = task * task_elements, n = min(values.size() - i0, task_elements);
+            span<double> block(values.data() + i0, n);
+
+            switch (op) {
+            case holtsmark_daemon_pdf:
+                holtsmark_pdf_batch(block, block);
+                break;
+            case holtsmark_daemon_cdf:
+                holtsmark_cdf_batch(block, block, 0, 1, complementary);
+                break;
+            case holtsmark_daemon_quantile:
+                holtsmark_quantile_batch(block, block, 0, 1, complementary);
+                break;
+            }
+        }, pool);
+
+        size_t offset = 0;
+        for (pending* item : items) {
+            const holtsmark_daemon_request& request = item->request;
+
+            for (double& y : item->values) {
+                double v = values[offset++];
+
+                y = (op == holtsmark_daemon_pdf) ? v / request.c
+                    : (op == holtsmark_daemon_quantile) ? request.mu + request.c * v
+                    : v;
+            }
+        }
+
+        batches.fetch_add(1, memory_order_relaxed);
+    }
+
+    void evaluate(vector<pending>& batch) {
+        vector<pending*> pdf, cdf_lower, cdf_upper, quantile_lower, quantile_upper, samples;
+
+        for (pending& item : batch) {
+            const holtsmark_daemon_request& request = item.request;
+
+            bool valid_scale = request.op == holtsmark_daemon_stats || (request.c > 0 && isfinite(request.c) && isfinite(request.mu));
+            if (!valid_scale) {
+                item.status = holtsmark_daemon_bad_request;
+                item.values.clear();
+                continue;
+            }
+
+            switch (request.op) {
+            case holtsmark_daemon_pdf:
+                pdf.push_back(&item);
+                break;
+            case holtsmark_daemon_cdf:
+                (request.complementary ? cdf_upper : cdf_lower).push_back(&item);
+                break;
+            case holtsmark_daemon_quantile:
+                (request.complementary ? quantile_upper : quantile_lower).push_back(&item);
+                break;
+            case holtsmark_daemon_sample:
+                samples.push_back(&item);
+                break;
+            case holtsmark_daemon_stats: {
+                holtsmark_daemon_counters stats = counters();
+                item.values = {
+                    (double)stats.requests, (double)stats.elements, (double)stats.batches,
+                    (double)stats.latency_total_ns, (double)stats.latency_max_ns, (double)stats.uptime_ns
+                };
+                break;
+            }
+            default:
+                item.status = holtsmark_daemon_bad_request;
+                item.values.clear();
+            }
+        }
+
+        if (!pdf.empty()) {
+            evaluate_coalesced(pdf, holtsmark_daemon_pdf, false);
+        }
+        if (!cdf_lower.empty()) {
+            evaluate_coalesced(cdf_lower, holtsmark_daemon_cdf, false);
+        }
+        if (!cdf_upper.empty()) {
+            evaluate_coalesced(cdf_upper, holtsmark_daemon_cdf, true);
+        }
+        if (!quantile_lower.empty()) {
+            evaluate_coalesced(quantile_lower, holtsmark_daemon_quantile, false);
+        }
+        if (!quantile_upper.empty()) {
+            evaluate_coalesced(quantile_upper, holtsmark_daemon_quantile, true);
+        }
+
+        // each sample request owns its seeded stream, so requests are the parallel tasks
+        parallel_for(samples.size(), [&](size_t i) {
+            pending* item = samples[i];
+
+            mt19937_64 engine(item->request.seed);
+            holtsmark_sample_batch(engine, item->values, item->request.mu, item->request.c);
+        }, pool);
+    }
+
+    void respond(vector<pending>& batch) {
+        for (pending& item : batch) {
+            auto conn = find_if(connections.begin(), connections.end(), [&](const connection& conn) {
+                return conn.fd == item.fd;
+            });
+            if (conn == connections.end() || conn->broken) {
+                continue;
+            }
+
+            holtsmark_daemon_response response{ item.status, (uint32_t)item.values.size() };
+
+            const uint8_t* header = (const uint8_t*)&response;
+            const uint8_t* body = (const uint8_t*)item.values.data();
+
+            conn->output.insert(conn->output.end(), header, header + sizeof(response));
+            conn->output.insert(conn->output.end(), body, body + item.values.size() * sizeof(double));
+
+            uint64_t latency = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - item.received).count();
+
+            requests.fetch_add(1, memory_order_relaxed);
+            elements.fetch_add(item.values.size(), memory_order_relaxed);
+            latency_total_ns.fetch_add(latency, memory_order_relaxed);
+
+            uint64_t current = latency_max_ns.load(memory_order_relaxed);
+            while (latency > current && !latency_max_ns.compare_exchange_weak(current, latency, memory_order_relaxed));
+        }
+
+        for (connection& conn : connections) {
+            flush(conn);
+        }
+    }
+
+    // a peer that has gone away (EPIPE, ECONNRESET, ...) drops the connection with its queued input and output
+    void flush(connection& conn) {
+        size_t offset = 0;
+        while (offset < conn.output.size()) {
+            ssize_t n = holtsmark_daemon_send(conn.fd, conn.output.data() + offset, conn.output.size() - offset);
+            if (n <= 0) {
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    conn.closed = conn.broken = true;
+                    conn.input.clear();
+                    conn.output.clear();
+                    return;
+                }
+                break;
+            }
+            offset += n;
+        }
+
+        conn.output.erase(conn.output.begin(), conn.output.begin() + offset);
+    }
+};
+
+// blocking client, mainly for tests and c++ consumers of a shared daemon
+int holtsmark_daemon_connect(string path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    holtsmark_daemon_nosigpipe(fd);
+
+    return fd;
+}
+
+bool holtsmark_daemon_call(int fd, holtsmark_daemon_request request, span<const double> input, vector<double>& output) {
+    auto write_all = [&](const void* data, size_t bytes) {
+        for (size_t offset = 0; offset < bytes;) {
+            ssize_t n = holtsmark_daemon_send(fd, (const uint8_t*)data + offset, bytes - offset);
+            if (n <= 0) {
+                return false;
+            }
+            offset += n;
+        }
+        return true;
+    };
+    auto read_all = [&](void* data, size_t bytes) {
+        for (size_t offset = 0; offset < bytes;) {
+            ssize_t n = read(fd, (uint8_t*)data + offset, bytes - offset);
+            if (n <= 0) {
+                return false;
+            }
+            offset += n;
+        }
+        return true;
+    };
+
+    if (!write_all(&request, sizeof(request)) || !write_all(input.data(), input.size() * sizeof(double))) {
+        return false;
+    }
+
+    holtsmark_daemon_response response;
+    if (!read_all(&response, sizeof(response))) {
+        return false;
+    }
+
+    output.resize(response.count);
+    if (!read_all(output.data(), response.count * sizeof(double))) {
+        return false;
+    }
+
+    return response.status == holtsmark_daemon_ok;
+}
+
+#endif
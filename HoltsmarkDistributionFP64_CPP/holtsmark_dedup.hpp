@@ -0,0 +1,296 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// quantized inputs: evaluate once per distinct value and scatter,
+// or tabulate integer codes x = offset + scale * code directly.
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+
+using namespace std;
+
+// elements inspected to estimate the cardinality
+const size_t holtsmark_dedup_sample = 4096;
+
+// deduplicate when distinct values are at most this fraction of the elements
+const double holtsmark_dedup_ratio = 0.25;
+
+// and at most this many, beyond which the slot table falls out of L2 and random probes cost
+// more than the kernel evaluations they save
+const size_t holtsmark_dedup_max_distinct = 1 << 15;
+
+enum class holtsmark_dedup_hint {
+    automatic, low_cardinality, high_cardinality
+};
+
+// estimated fraction of distinct values in x.
+// d distinct values among m pseudo-random positions (drawn with replacement) are matched to the
+// cardinality D of the whole array by d = D (1 - exp(-m / D)), which assumes evenly used values;
+// skewed data is underestimated and caught by the limit in holtsmark_dedup_apply.
+double holtsmark_distinct_fraction(span<const double> x) {
+    if (x.empty()) {
+        return 1;
+    }
+
+    size_t n = x.size(), m = holtsmark_dedup_sample;
+
+    vector<uint64_t> keys(min(n, m));
+    if (n <= m) {
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = bit_cast<uint64_t>(x[i]);
+        }
+    }
+    else {
+        // splitmix64 positions, strided positions would see runs of sorted data as all distinct
+        uint64_t state = 0;
+        for (size_t i = 0; i < m; i++) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+
+            keys[i] = bit_cast<uint64_t>(x[(size_t)(z % n)]);
+        }
+    }
+
+    sort(keys.begin(), keys.end());
+
+    double distinct = (double)(unique(keys.begin(), keys.end()) - keys.begin());
+
+    if (n <= m) {
+        return distinct / (double)n;
+    }
+
+    auto expected = [&](double d) { return d * -expm1(-(double)m / d); };
+
+    if (expected((double)n) <= distinct) {
+        return 1;
+    }
+
+    // expected is increasing in d, bisect on log d
+    double lo = distinct, hi = (double)n;
+    for (int iter = 0; iter < 64 && hi > lo * (1 + 1e-3); iter++) {
+        double mid = sqrt(lo * hi);
+        (expected(mid) < distinct ? lo : hi) = mid;
+    }
+
+    return hi / (double)n;
+}
+
+// open addressing on the bit patterns of the values, load factor at most 1/2.
+// slots hold value index + 1, 0 is empty.
+class dedup_slots {
+public:
+    explicit dedup_slots(size_t capacity) {
+        resize(bit_ceil(max(capacity * 2, (size_t)64)));
+    }
+
+    // index of key, next when it was absent (then inserted)
+    uint32_t find_or_insert(uint64_t key, uint32_t next, bool& inserted) {
+        if (2 * ((size_t)next + 1) > keys.size()) {
+            grow();
+        }
+
+        for (size_t h = hash(key); ; h = (h + 1) & mask) {
+            if (slots[h] == 0) {
+                keys[h] = key;
+                slots[h] = next + 1;
+                inserted = true;
+                return next;
+            }
+            if (keys[h] == key) {
+                inserted = false;
+                return slots[h] - 1;
+            }
+        }
+    }
+
+private:
+    vector<uint64_t> keys;
+    vector<uint32_t> slots;
+    size_t mask = 0;
+    int shift = 0;
+
+    size_t hash(uint64_t key) const {
+        return (size_t)((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    void resize(size_t size) {
+        keys.assign(size, 0);
+        slots.assign(size, 0);
+        mask = size - 1;
+        shift = 64 - countr_zero(size);
+    }
+
+    void grow() {
+        vector<uint64_t> old_keys;
+        vector<uint32_t> old_slots;
+        swap(old_keys, keys);
+        swap(old_slots, slots);
+
+        resize(old_keys.size() * 2);
+
+        for (size_t i = 0; i < old_keys.size(); i++) {
+            if (old_slots[i] == 0) {
+                continue;
+            }
+
+            size_t h = hash(old_keys[i]);
+            while (slots[h] != 0) {
+                h = (h + 1) & mask;
+            }
+            keys[h] = old_keys[i];
+            slots[h] = old_slots[i];
+        }
+    }
+};
+
+// kernel(span<const double> x, span<double> y) is one of the location-scale batch kernels.
+// returns the number of kernel evaluations, x.size() when the plain kernel was used.
+template <class Kernel>
+size_t holtsmark_dedup_apply(span<const double> x, span<double> y, Kernel kernel, holtsmark_dedup_hint hint) {
+    assert(x.size() == y.size());
+
+    size_t expected = holtsmark_dedup_sample;
+
+    if (hint == holtsmark_dedup_hint::automatic) {
+        double fraction = holtsmark_distinct_fraction(x), distinct = fraction * (double)x.size();
+
+        if (fraction > holtsmark_dedup_ratio || distinct > (double)holtsmark_dedup_max_distinct) {
+            kernel(x, y);
+            return x.size();
+        }
+
+        expected = max(expected, (size_t)(distinct * 1.25));
+    }
+    else if (hint == holtsmark_dedup_hint::high_cardinality) {
+        kernel(x, y);
+        return x.size();
+    }
+
+    // the estimate may miss a long tail of distinct values, give up past twice the bounds
+    size_t limit = max(min((size_t)(x.size() * holtsmark_dedup_ratio), 2 * holtsmark_dedup_max_distinct),
+        holtsmark_dedup_sample);
+
+    dedup_slots slots(min(expected, limit));
+
+    vector<double> values;
+    vector<uint32_t> indexes(x.size());
+
+    for (size_t i = 0; i < x.size(); i++) {
+        bool inserted;
+        uint32_t index = slots.find_or_insert(bit_cast<uint64_t>(x[i]), (uint32_t)values.size(), inserted);
+
+        if (inserted) {
+            if (values.size() >= limit) {
+                kernel(x, y);
+                return x.size();
+            }
+
+            values.push_back(x[i]);
+        }
+
+        indexes[i] = index;
+    }
+
+    vector<double> results(values.size());
+    kernel(values, results);
+
+    for (size_t i = 0; i < x.size(); i++) {
+        y[i] = results[indexes[i]];
+    }
+
+    return values.size();
+}
+
+size_t holtsmark_pdf_dedup_batch(span<const double> x, span<double> y, double mu = 0, double c = 1,
+    holtsmark_dedup_hint hint = holtsmark_dedup_hint::automatic) {
+
+    return holtsmark_dedup_apply(x, y,
+        [=](span<const double> v, span<double> w) { holtsmark_pdf_batch(v, w, mu, c); }, hint);
+}
+
+size_t holtsmark_cdf_dedup_batch(span<const double> x, span<double> y, double mu = 0, double c = 1, bool complementary = false,
+    holtsmark_dedup_hint hint = holtsmark_dedup_hint::automatic) {
+
+    return holtsmark_dedup_apply(x, y,
+        [=](span<const double> v, span<double> w) { holtsmark_cdf_batch(v, w, mu, c, complementary); }, hint);
+}
+
+// direct lookup of integer codes in [code_min, code_max], x = offset + scale * code.
+// codes outside the range are evaluated directly.
+class holtsmark_code_table {
+public:
+    enum class kind {
+        pdf, cdf, ccdf
+    };
+
+    holtsmark_code_table(kind function, int32_t code_min, int32_t code_max,
+        double offset = 0, double scale = 1, double mu = 0, double c = 1)
+        : function(function), code_min(code_min), offset(offset), scale(scale), mu(mu), c(c) {
+
+        assert(code_min <= code_max);
+
+        vector<double> x((size_t)((int64_t)code_max - code_min + 1));
+        for (size_t i = 0; i < x.size(); i++) {
+            x[i] = to_x(code_min + (int64_t)i);
+        }
+
+        table.resize(x.size());
+        evaluate(x, table);
+    }
+
+    void operator()(span<const int32_t> codes, span<double> y) const {
+        assert(codes.size() == y.size());
+
+        for (size_t i = 0; i < codes.size(); i++) {
+            uint64_t index = (uint64_t)((int64_t)codes[i] - code_min);
+
+            if (index < table.size()) {
+                y[i] = table[index];
+            }
+            else {
+                double x = to_x(codes[i]);
+                evaluate(span<const double>(&x, 1), span<double>(&y[i], 1));
+            }
+        }
+    }
+
+    size_t size() const {
+        return table.size();
+    }
+
+private:
+    kind function;
+    int64_t code_min;
+    double offset, scale, mu, c;
+    vector<double> table;
+
+    double to_x(int64_t code) const {
+        return offset + scale * (double)code;
+    }
+
+    void evaluate(span<const double> x, span<double> y) const {
+        switch (function) {
+        case kind::pdf:
+            holtsmark_pdf_batch(x, y, mu, c);
+            break;
+        case kind::cdf:
+            holtsmark_cdf_batch(x, y, mu, c, false);
+            break;
+        case kind::ccdf:
+            holtsmark_cdf_batch(x, y, mu, c, true);
+            break;
+        }
+    }
+};
@@ -10,11 +10,14 @@
 #include <cassert>
 #include <numbers>
 #include <limits>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 
 using namespace std;
 using namespace std::numbers;
 
-double poly(double x, vector<double> coef) {
+double poly(double x, const vector<double>& coef) {
     double s = coef[coef.size() - 1];
 
     for (int i = coef.size() - 2; i >= 0; i--) {
@@ -24,7 +27,7 @@ double poly(double x, vector<double> coef) {
     return s;
 }
 
-double pade(double x, vector<double> numer, vector<double> denom) {
+double pade(double x, const vector<double>& numer, const vector<double>& denom) {
     double sc = poly(x, numer), sd = poly(x, denom);
 
     assert(sd >= 0.5);
@@ -40,7 +43,87 @@ double cube(double x) {
     return x * x * x;
 }
 
-double holtsmark_pdf(double x) {
+// x^-3/2, one division and one correctly rounded square root
+double pow_m1p5(double x) {
+    double r = 1 / x;
+
+    return r * sqrt(r);
+}
+
+// x^-5/2, shares 1 / x and sqrt with pow_m1p5 after inlining
+double pow_m2p5(double x) {
+    double r = 1 / x;
+
+    return r * r * sqrt(r);
+}
+
+// |x|^-2/3 without cbrt: x = m 2^(3q + r), m in [1, 2),
+// polynomial start for m^-2/3 (rel. error 2.3e-5) and two newton steps on t^2 y^3 = 1, t = m 2^r.
+double pow_m2d3(double x) {
+    static const double scale_r[3] = {
+        1.00000000000000000000e0,
+        6.29960524947436582384e-1,
+        3.96850262992049868688e-1,
+    };
+    static const double poly_m[6] = {
+        7.63158126077874729095e-1,
+        -3.39184320302226727917e-1,
+        1.87335117961961277020e-1,
+        -1.10965863479722516917e-1,
+        7.95411635250585515825e-2,
+        -4.96454734665206978610e-2,
+    };
+
+    x = abs(x);
+
+    if (!(x >= numeric_limits<double>::min() && x < numeric_limits<double>::infinity())) {
+        if (x > 0 && x < numeric_limits<double>::min()) {
+            return pow_m2d3(x * 0x1p+96) * 0x1p+64;
+        }
+
+        return (x == 0) ? numeric_limits<double>::infinity() : (x > 0) ? 0 : x;
+    }
+
+    uint64_t bits = bit_cast<uint64_t>(x);
+    int exponent = (int)(bits >> 52) - 1023;
+    double m = bit_cast<double>((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull);
+
+    int q = (exponent + 1023) / 3 - 341;
+    int r = exponent - 3 * q;
+
+    double s = m - 1.5;
+    double y = poly_m[5];
+    for (int i = 4; i >= 0; i--) {
+        y = y * s + poly_m[i];
+    }
+    y *= scale_r[r];
+
+    double t = m * (double)(1 << r), t2 = t * t;
+
+    y += y * (1 - t2 * y * y * y) * (1. / 3.);
+    y += y * (1 - t2 * y * y * y) * (1. / 3.);
+
+    return y * bit_cast<double>((uint64_t)(1023 - 2 * q) << 52);
+}
+
+// rational approximation on one segment, pade(x - offset, numer, denom).
+// the limit segments are evaluated at u = |x|^-3/2 instead.
+struct pade_segment {
+    double offset;
+    vector<double> numer, denom;
+};
+
+// ceil(log2(x)) for finite x > 0
+int exponent_ceil(double x) {
+    uint64_t bits = bit_cast<uint64_t>(x);
+    int exponent = (int)(bits >> 52) - 1023;
+
+    return exponent + ((bits & 0x000FFFFFFFFFFFFFull) != 0 ? 1 : 0);
+}
+
+const int holtsmark_pdf_limit_index = 7;
+
+const vector<pade_segment>& holtsmark_pdf_segments() {
     static const vector<double> pade_plus_0_1_numer = {
         2.87352751452164445024e-1,
         1.18577398160636011811e-3,
@@ -199,40 +282,70 @@ double holtsmark_pdf(double x) {
         1.34068401972703571636e1,
     };
 
+    static const vector<pade_segment> segments = {
+        { 0, pade_plus_0_1_numer, pade_plus_0_1_denom },
+        { 1, pade_plus_1_2_numer, pade_plus_1_2_denom },
+        { 2, pade_plus_2_4_numer, pade_plus_2_4_denom },
+        { 4, pade_plus_4_8_numer, pade_plus_4_8_denom },
+        { 8, pade_plus_8_16_numer, pade_plus_8_16_denom },
+        { 16, pade_plus_16_32_numer, pade_plus_16_32_denom },
+        { 32, pade_plus_32_64_numer, pade_plus_32_64_denom },
+        { 64, pade_plus_limit_numer, pade_plus_limit_denom },
+    };
+
+    return segments;
+}
+
+// segment of |x|: [0, 1], (1, 2], (2, 4], ..., (32, 64], limit
+int holtsmark_pdf_segment_index(double x) {
     x = abs(x);
 
-    double y;
-    if (x <= 1) {
-        y = pade(x, pade_plus_0_1_numer, pade_plus_0_1_denom);
-    }
-    else if (x <= 2) {
-        y = pade(x - 1, pade_plus_1_2_numer, pade_plus_1_2_denom);
-    }
-    else if (x <= 4) {
-        y = pade(x - 2, pade_plus_2_4_numer, pade_plus_2_4_denom);
+    if (!(x <= 64)) {
+        return holtsmark_pdf_limit_index;
     }
-    else if (x <= 8) {
-        y = pade(x - 4, pade_plus_4_8_numer, pade_plus_4_8_denom);
-    }
-    else if (x <= 16) {
-        y = pade(x - 8, pade_plus_8_16_numer, pade_plus_8_16_denom);
-    }
-    else if (x <= 32) {
-        y = pade(x - 16, pade_plus_16_32_numer, pade_plus_16_32_denom);
-    }
-    else if (x <= 64) {
-        y = pade(x - 32, pade_plus_32_64_numer, pade_plus_32_64_denom);
+
+    return max(0, exponent_ceil(x));
+}
+
+double holtsmark_pdf(double x) {
+    const vector<pade_segment>& segments = holtsmark_pdf_segments();
+
+    x = abs(x);
+
+    int index = holtsmark_pdf_segment_index(x);
+    const pade_segment& segment = segments[index];
+
+    double y;
+    if (index < holtsmark_pdf_limit_index) {
+        y = pade(x - segment.offset, segment.numer, segment.denom);
     }
     else {
-        double u = 1 / cube(sqrt(x));
+        double u = pow_m1p5(x);
 
-        y = pade(u, pade_plus_limit_numer, pade_plus_limit_denom) * u / x;
+        y = pade(u, segment.numer, segment.denom) * pow_m2p5(x);
     }
 
     return y;
 }
 
-double holtsmark_cdf(double x, bool complementary = false) {
+double holtsmark_logpdf(double x) {
+    x = abs(x);
+
+    if (x <= 0x1p+128) {
+        return log(holtsmark_pdf(x));
+    }
+
+    // pdf(x) ~ pade_plus_limit_numer[0] * x^-5/2, before x^-5/2 underflows
+    static const double log_limit = log(holtsmark_pdf_segments()[holtsmark_pdf_limit_index].numer[0]);
+
+    double y = log_limit - 2.5 * log(x);
+
+    return y;
+}
+
+const int holtsmark_cdf_limit_index = 8;
+
+const vector<pade_segment>& holtsmark_cdf_segments() {
     static const vector<double> pade_plus_0_0p5_numer = {
         5.00000000000000000000e-1,
         -1.34752580674786639030e-1,
@@ -402,39 +515,53 @@ double holtsmark_cdf(double x, bool complementary = false) {
         8.04408113719341786819e0,
     };
 
-    bool inversion = (x <= 0) ^ complementary;
+    static const vector<pade_segment> segments = {
+        { 0, pade_plus_0_0p5_numer, pade_plus_0_0p5_denom },
+        { 0.5, pade_plus_0p5_1_numer, pade_plus_0p5_1_denom },
+        { 1, pade_plus_1_2_numer, pade_plus_1_2_denom },
+        { 2, pade_plus_2_4_numer, pade_plus_2_4_denom },
+        { 4, pade_plus_4_8_numer, pade_plus_4_8_denom },
+        { 8, pade_plus_8_16_numer, pade_plus_8_16_denom },
+        { 16, pade_plus_16_32_numer, pade_plus_16_32_denom },
+        { 32, pade_plus_32_64_numer, pade_plus_32_64_denom },
+        { 64, pade_plus_limit_numer, pade_plus_limit_denom },
+    };
 
+    return segments;
+}
+
+// segment of |x|: [0, 0.5], (0.5, 1], (1, 2], ..., (32, 64], limit
+int holtsmark_cdf_segment_index(double x) {
     x = abs(x);
 
-    double y;
-    if (x <= 0.5) {
-        y = pade(x, pade_plus_0_0p5_numer, pade_plus_0_0p5_denom);
-    }
-    else if (x <= 1) {
-        y = pade(x - 0.5, pade_plus_0p5_1_numer, pade_plus_0p5_1_denom);
-    }
-    else if (x <= 2) {
-        y = pade(x - 1, pade_plus_1_2_numer, pade_plus_1_2_denom);
+    if (!(x <= 64)) {
+        return holtsmark_cdf_limit_index;
     }
-    else if (x <= 4) {
-        y = pade(x - 2, pade_plus_2_4_numer, pade_plus_2_4_denom);
-    }
-    else if (x <= 8) {
-        y = pade(x - 4, pade_plus_4_8_numer, pade_plus_4_8_denom);
-    }
-    else if (x <= 16) {
-        y = pade(x - 8, pade_plus_8_16_numer, pade_plus_8_16_denom);
-    }
-    else if (x <= 32) {
-        y = pade(x - 16, pade_plus_16_32_numer, pade_plus_16_32_denom);
+    if (x <= 0.5) {
+        return 0;
     }
-    else if (x <= 64) {
-        y = pade(x - 32, pade_plus_32_64_numer, pade_plus_32_64_denom);
+
+    return exponent_ceil(x) + 1;
+}
+
+double holtsmark_cdf(double x, bool complementary = false) {
+    const vector<pade_segment>& segments = holtsmark_cdf_segments();
+
+    bool inversion = (x <= 0) ^ complementary;
+
+    x = abs(x);
+
+    int index = holtsmark_cdf_segment_index(x);
+    const pade_segment& segment = segments[index];
+
+    double y;
+    if (index < holtsmark_cdf_limit_index) {
+        y = pade(x - segment.offset, segment.numer, segment.denom);
     }
     else {
-        double u = 1 / cube(sqrt(x));
+        double u = pow_m1p5(x);
 
-        y = pade(u, pade_plus_limit_numer, pade_plus_limit_denom) * u;
+        y = pade(u, segment.numer, segment.denom) * u;
     }
 
     y = inversion ? y : 1 - y;
@@ -655,10 +782,11 @@ double holtsmark_quantile(double x, bool complementary = false) {
         v = pade(-log2(ldexp(x, 32)), pade_plus_expm32_64_numer, pade_plus_expm32_64_denom);
     }
     else {
-        v = 1 / ldexp(cbrt(pi), 1);
+        // 1 / (2 cbrt(pi))
+        v = 3.41392031627647840734e-1;
     }
 
-    double y = v / square(cbrt(x));
+    double y = v * pow_m2d3(x);
 
     y = complementary ? y : -y;
 
@@ -0,0 +1,103 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// cross-entropy and kl divergence between holtsmark distributions.
+// with x = mu1 + c1 t, t ~ holtsmark(0, 1):
+//   H(P1, P2) = log c2 - E[logpdf(d + r t)], d = (mu1 - mu2) / c2, r = c1 / c2
+//   KL(P1 || P2) = H(P1, P2) - H(P1), H(P1) = holtsmark_entropy_base + log c1
+// the expectation uses holtsmark_expectation_rule with the segment breaks of both densities,
+// so every interval is smooth for both factors. the base rules and the unsplit standard
+// intervals are cached, a pair evaluates the pdf on the split intervals and the logpdf on all nodes.
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_parallel.hpp"
+#include "holtsmark_quadrature.hpp"
+
+using namespace std;
+
+const double holtsmark_entropy_base = 2.06944850513462440032;
+
+double holtsmark_entropy(double c = 1) {
+    return holtsmark_entropy_base + log(c);
+}
+
+// E[logpdf(d + r t)], t ~ holtsmark(0, 1), r > 0
+double holtsmark_expected_logpdf(double d, double r, size_t order = 12, size_t tail_order = 18) {
+    assert(r > 0);
+
+    // both densities are in their limit segments beyond t_limit, and the zero of d + r t
+    // is kept far from the tail so that log(d + r t) is smooth under the tail substitution
+    double t_limit = max(64.0, (64 + 8 * abs(d)) / r);
+    double z_limit = abs(d) + r * t_limit;
+
+    vector<double> breaks = holtsmark_segment_breaks(t_limit);
+
+    for (double z : holtsmark_segment_breaks(z_limit)) {
+        double t = (z - d) / r;
+
+        if (abs(t) < t_limit) {
+            breaks.push_back(t);
+        }
+    }
+
+    breaks.push_back(-t_limit);
+    breaks.push_back(t_limit);
+
+    sort(breaks.begin(), breaks.end());
+    breaks.erase(unique(breaks.begin(), breaks.end()), breaks.end());
+
+    quadrature_rule rule = holtsmark_expectation_rule(breaks, order, tail_order);
+
+    vector<double> logpdf(rule.nodes.size());
+    for (size_t i = 0; i < rule.nodes.size(); i++) {
+        logpdf[i] = d + r * rule.nodes[i];
+    }
+    holtsmark_logpdf_batch(logpdf, logpdf);
+
+    double s = 0;
+    for (size_t i = 0; i < rule.nodes.size(); i++) {
+        s += rule.weights[i] * logpdf[i];
+    }
+
+    return s;
+}
+
+double holtsmark_cross_entropy(double mu1, double c1, double mu2, double c2) {
+    return log(c2) - holtsmark_expected_logpdf((mu1 - mu2) / c2, c1 / c2);
+}
+
+double holtsmark_kl_divergence(double mu1, double c1, double mu2, double c2) {
+    double kl = holtsmark_cross_entropy(mu1, c1, mu2, c2) - holtsmark_entropy(c1);
+
+    return max(0.0, kl);
+}
+
+// parameter arrays of equal length, one pair per element
+void holtsmark_cross_entropy_batch(span<const double> mu1, span<const double> c1,
+    span<const double> mu2, span<const double> c2, span<double> y, size_t threads = 0) {
+
+    assert(mu1.size() == y.size() && c1.size() == y.size() && mu2.size() == y.size() && c2.size() == y.size());
+
+    parallel_for(y.size(), [&](size_t i) {
+        y[i] = holtsmark_cross_entropy(mu1[i], c1[i], mu2[i], c2[i]);
+    }, threads);
+}
+
+void holtsmark_kl_divergence_batch(span<const double> mu1, span<const double> c1,
+    span<const double> mu2, span<const double> c2, span<double> y, size_t threads = 0) {
+
+    assert(mu1.size() == y.size() && c1.size() == y.size() && mu2.size() == y.size() && c2.size() == y.size());
+
+    parallel_for(y.size(), [&](size_t i) {
+        y[i] = holtsmark_kl_divergence(mu1[i], c1[i], mu2[i], c2[i]);
+    }, threads);
+}
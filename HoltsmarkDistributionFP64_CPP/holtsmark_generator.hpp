@@ -0,0 +1,152 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <utility>
+#include <iterator>
+#include <coroutine>
+#include <exception>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_random.hpp"
+
+using namespace std;
+
+namespace holtsmark {
+    // minimal single pass generator coroutine (std::generator is C++23).
+    // values are pulled either by next() or by iterating.
+    template <class T>
+    class generator {
+    public:
+        struct promise_type {
+            T value;
+            exception_ptr exception;
+
+            generator get_return_object() {
+                return generator(coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            suspend_always final_suspend() noexcept {
+                return {};
+            }
+
+            suspend_always yield_value(T v) noexcept {
+                value = v;
+                return {};
+            }
+
+            void return_void() noexcept {}
+
+            void unhandled_exception() {
+                exception = current_exception();
+            }
+        };
+
+        class iterator {
+        public:
+            using value_type = T;
+            using difference_type = ptrdiff_t;
+
+            iterator() = default;
+
+            explicit iterator(coroutine_handle<promise_type> handle) : handle(handle) {}
+
+            T operator*() const {
+                return handle.promise().value;
+            }
+
+            iterator& operator++() {
+                handle.resume();
+                rethrow(handle);
+                return *this;
+            }
+
+            void operator++(int) {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, default_sentinel_t) {
+                return !it.handle || it.handle.done();
+            }
+
+        private:
+            coroutine_handle<promise_type> handle = nullptr;
+        };
+
+        generator(generator&& other) noexcept : handle(exchange(other.handle, nullptr)) {}
+
+        generator& operator=(generator&& other) noexcept {
+            if (this != &other) {
+                if (handle) {
+                    handle.destroy();
+                }
+                handle = exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+
+        ~generator() {
+            if (handle) {
+                handle.destroy();
+            }
+        }
+
+        // next value, the generator must not be exhausted
+        T next() {
+            handle.resume();
+            rethrow(handle);
+            return handle.promise().value;
+        }
+
+        T operator()() {
+            return next();
+        }
+
+        iterator begin() {
+            handle.resume();
+            rethrow(handle);
+            return iterator(handle);
+        }
+
+        default_sentinel_t end() const {
+            return default_sentinel;
+        }
+
+    private:
+        coroutine_handle<promise_type> handle;
+
+        explicit generator(coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        static void rethrow(coroutine_handle<promise_type> handle) {
+            if (handle.promise().exception) {
+                rethrow_exception(handle.promise().exception);
+            }
+        }
+    };
+
+    // endless stream of variates, a block of refill values is generated by the batch sampler
+    // and yielded one by one, so a single draw costs an amortized share of a batch.
+    // the engine is taken by value, e.g. philox_engine(stream) for a reproducible counter-based stream.
+    // refill is clamped to at least 1.
+    template <class Engine = philox_engine>
+    generator<double> sample_stream(Engine engine, double mu = 0, double c = 1, size_t refill = 1024) {
+        vector<double> buffer(max(refill, (size_t)1));
+
+        for (;;) {
+            holtsmark_sample_batch(engine, span<double>(buffer), mu, c);
+
+            for (double x : buffer) {
+                co_yield x;
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_parallel.hpp"
+#include "holtsmark_reduction.hpp"
+
+using namespace std;
+
+// query points per tile
+const size_t holtsmark_kde_query_tile = 64;
+
+// pdf(x) <= holtsmark_pdf_tail_bound * |x|^(-5/2) for all x
+const double holtsmark_pdf_tail_bound = 0.51;
+
+// kernel density estimate f(q) = 1/(n h) sum_i pdf((q - samples[i]) / h) at every query point.
+// tasks are query tiles, each L1-sized sample block is swept over the whole tile.
+// tolerance > 0 sorts both sides and skips pairs with |q - s| > r h, where the skipped mass
+// is at most tolerance (absolute, in density units) per query.
+// the result does not depend on the thread count.
+// a nan sample makes every estimate nan, nan queries give nan and infinite queries 0;
+// both are taken out before the sorts, nan has no order.
+vector<double> holtsmark_kde(span<const double> samples, span<const double> queries,
+    double bandwidth, double tolerance = 0, size_t threads = 0) {
+
+    size_t n = samples.size();
+
+    vector<double> density(queries.size(), 0);
+    if (n == 0 || queries.empty()) {
+        return density;
+    }
+
+    if (any_of(samples.begin(), samples.end(), [](double s) { return isnan(s); })) {
+        fill(density.begin(), density.end(), numeric_limits<double>::quiet_NaN());
+        return density;
+    }
+
+    vector<size_t> order;
+    order.reserve(queries.size());
+
+    for (size_t q = 0; q < queries.size(); q++) {
+        if (isfinite(queries[q])) {
+            order.push_back(q);
+        }
+        else if (isnan(queries[q])) {
+            density[q] = numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    size_t m = order.size();
+    if (m == 0) {
+        return density;
+    }
+
+    bool truncate = tolerance > 0;
+
+    vector<double> sorted_samples;
+
+    if (truncate) {
+        sorted_samples.assign(samples.begin(), samples.end());
+        sort(sorted_samples.begin(), sorted_samples.end());
+        samples = sorted_samples;
+
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) { return queries[a] < queries[b]; });
+    }
+
+    double radius = truncate
+        ? pow(holtsmark_pdf_tail_bound / (tolerance * bandwidth), 0.4) * bandwidth
+        : 0;
+
+    size_t tiles = (m + holtsmark_kde_query_tile - 1) / holtsmark_kde_query_tile;
+
+    parallel_for(tiles, [&](size_t tile) {
+        size_t q0 = tile * holtsmark_kde_query_tile, q1 = min(m, q0 + holtsmark_kde_query_tile);
+
+        size_t i0 = 0, i1 = n;
+        if (truncate) {
+            double qmin = queries[order[q0]], qmax = queries[order[q1 - 1]];
+
+            i0 = (size_t)(lower_bound(samples.begin(), samples.end(), qmin - radius) - samples.begin());
+            i1 = (size_t)(upper_bound(samples.begin(), samples.end(), qmax + radius) - samples.begin());
+        }
+
+        double sums[holtsmark_kde_query_tile] = {};
+        double buffer[holtsmark_batch_block];
+
+        for (size_t b0 = i0; b0 < i1; b0 += holtsmark_batch_block) {
+            size_t bn = min(i1 - b0, holtsmark_batch_block);
+
+            span<const double> block = samples.subspan(b0, bn);
+
+            for (size_t q = q0; q < q1; q++) {
+                holtsmark_pdf_batch(block, span<double>(buffer, bn), queries[order[q]], bandwidth);
+
+                sums[q - q0] += pairwise_sum(span<const double>(buffer, bn));
+            }
+        }
+
+        for (size_t q = q0; q < q1; q++) {
+            density[order[q]] = sums[q - q0] / (double)n;
+        }
+    }, threads);
+
+    return density;
+}
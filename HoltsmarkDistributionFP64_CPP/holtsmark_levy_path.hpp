@@ -0,0 +1,111 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// alpha = 3/2 symmetric levy flights, x(t + dt) = x(t) + drift dt + c dt^(2/3) h, h ~ holtsmark.
+// increments are drawn blockwise by the batch sampler, prefix summed in place and
+// checked against the barriers in the same pass.
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_random.hpp"
+#include "holtsmark_parallel.hpp"
+
+using namespace std;
+
+struct levy_path_options {
+    double x0 = 0, drift = 0, c = 1, dt = 1;
+
+    // absorbing barriers, first passage is lower >= x or x >= upper
+    double lower = -numeric_limits<double>::infinity();
+    double upper = numeric_limits<double>::infinity();
+
+    // stop a path at its first passage, the remaining positions stay at the crossing value
+    bool stop_at_barrier = false;
+
+    // keep every position, otherwise only the final values
+    bool store_paths = true;
+
+    uint64_t seed = 0;
+};
+
+struct levy_path_ensemble {
+    size_t paths = 0, steps = 0;
+
+    // positions after each step, path major: values[p * steps + s]
+    vector<double> values;
+
+    vector<double> final_values;
+
+    // step index of the first passage, -1 if none
+    vector<int64_t> first_passage;
+
+    span<const double> path(size_t p) const {
+        return span<const double>(values).subspan(p * steps, steps);
+    }
+};
+
+// path p uses the philox stream (seed, 2 * steps * p), so the ensemble does not depend on the thread count
+levy_path_ensemble levy_simulate_paths(size_t paths, size_t steps, const levy_path_options& options, size_t threads = 0) {
+    levy_path_ensemble ensemble;
+    ensemble.paths = paths;
+    ensemble.steps = steps;
+    ensemble.final_values.resize(paths);
+    ensemble.first_passage.resize(paths);
+    if (options.store_paths) {
+        ensemble.values.resize(paths * steps);
+    }
+
+    double mu = options.drift * options.dt, c = options.c * pow(options.dt, 2.0 / 3.0);
+
+    parallel_for(paths, [&](size_t p) {
+        philox_engine engine(options.seed, 2 * steps * (uint64_t)p);
+
+        double buffer[holtsmark_batch_block];
+
+        double x = options.x0;
+        int64_t passage = -1;
+
+        for (size_t s0 = 0; s0 < steps; s0 += holtsmark_batch_block) {
+            size_t sn = min(steps - s0, holtsmark_batch_block);
+
+            span<double> block = options.store_paths
+                ? span<double>(ensemble.values).subspan(p * steps + s0, sn)
+                : span<double>(buffer, sn);
+
+            if (passage >= 0 && options.stop_at_barrier) {
+                fill(block.begin(), block.end(), x);
+                continue;
+            }
+
+            holtsmark_sample_batch(engine, block, mu, c);
+
+            for (size_t i = 0; i < sn; i++) {
+                x += block[i];
+                block[i] = x;
+
+                if (passage < 0 && !(x > options.lower && x < options.upper)) {
+                    passage = (int64_t)(s0 + i);
+
+                    if (options.stop_at_barrier) {
+                        fill(block.begin() + i + 1, block.end(), x);
+                        break;
+                    }
+                }
+            }
+        }
+
+        ensemble.final_values[p] = x;
+        ensemble.first_passage[p] = passage;
+    }, threads);
+
+    return ensemble;
+}
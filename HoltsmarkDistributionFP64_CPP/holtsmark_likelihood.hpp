@@ -0,0 +1,85 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_parallel.hpp"
+#include "holtsmark_reduction.hpp"
+
+using namespace std;
+
+// total log-likelihood sum_i log p(data[i]; mu, c), reproducible for any thread count
+double holtsmark_loglikelihood(span<const double> data, double mu, double c, size_t threads = 0) {
+    return reproducible_sum(data.size(), [&](size_t i0, span<double> buffer) {
+        holtsmark_logpdf_batch(data.subspan(i0, buffer.size()), buffer, mu, c);
+    }, threads);
+}
+
+// grid points per tile
+const size_t holtsmark_likelihood_grid_tile = 64;
+// data elements per chunk, one reduction task of holtsmark_loglikelihood, so the grid follows
+// the same summation tree and agrees bit for bit with the scalar entry point
+const size_t holtsmark_likelihood_data_chunk = reduction_task_blocks * reduction_block;
+
+// total log-likelihood sum_i log p(data[i]; mu, c) at every grid point (mu[j], c[k]),
+// returned row-major as result[j * c.size() + k].
+// tasks are (data chunk, grid tile) pairs, inside a task each L1-sized data block is
+// swept over the whole grid tile before the next block is loaded.
+vector<double> holtsmark_loglikelihood_grid(
+    span<const double> data, span<const double> mu, span<const double> c, size_t threads = 0) {
+
+    size_t n = data.size(), grids = mu.size() * c.size();
+
+    size_t chunks = max((size_t)1, (n + holtsmark_likelihood_data_chunk - 1) / holtsmark_likelihood_data_chunk);
+    size_t tiles = (grids + holtsmark_likelihood_grid_tile - 1) / holtsmark_likelihood_grid_tile;
+
+    vector<double> partials(chunks * grids, 0);
+
+    parallel_for(chunks * tiles, [&](size_t task) {
+        size_t chunk = task / tiles, tile = task % tiles;
+
+        size_t i0 = chunk * holtsmark_likelihood_data_chunk, i1 = min(n, i0 + holtsmark_likelihood_data_chunk);
+        size_t g0 = tile * holtsmark_likelihood_grid_tile, g1 = min(grids, g0 + holtsmark_likelihood_grid_tile);
+
+        double* sums = partials.data() + chunk * grids;
+        double buffer[reduction_block];
+
+        // block_sums[(g - g0) * reduction_task_blocks + block]
+        vector<double> block_sums((g1 - g0) * reduction_task_blocks);
+        size_t blocks = 0;
+
+        for (size_t b0 = i0; b0 < i1; b0 += reduction_block, blocks++) {
+            size_t bn = min(i1 - b0, reduction_block);
+
+            span<const double> block = data.subspan(b0, bn);
+
+            for (size_t g = g0; g < g1; g++) {
+                holtsmark_logpdf_batch(block, span<double>(buffer, bn), mu[g / c.size()], c[g % c.size()]);
+
+                block_sums[(g - g0) * reduction_task_blocks + blocks] = pairwise_sum(span<const double>(buffer, bn));
+            }
+        }
+
+        for (size_t g = g0; g < g1; g++) {
+            sums[g] = pairwise_sum(span<const double>(block_sums.data() + (g - g0) * reduction_task_blocks, blocks));
+        }
+    }, threads);
+
+    vector<double> loglikelihood(grids, 0), chunk_sums(chunks);
+
+    for (size_t g = 0; g < grids; g++) {
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            chunk_sums[chunk] = partials[chunk * grids + g];
+        }
+
+        loglikelihood[g] = pairwise_sum(chunk_sums);
+    }
+
+    return loglikelihood;
+}
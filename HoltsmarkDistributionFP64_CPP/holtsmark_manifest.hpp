@@ -0,0 +1,118 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// content hashes of the generated result datasets, a dataset is regenerated only
+// when the hash of its grid and function fingerprint differs from the manifest entry.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <functional>
+#include <filesystem>
+
+using namespace std;
+
+const uint64_t manifest_hash_basis = 0xCBF29CE484222325ull;
+
+// fnv-1a over the bit patterns of the values
+uint64_t hash_values(uint64_t hash, const vector<double>& values) {
+    for (double v : values) {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+
+        for (int i = 0; i < 8; i++) {
+            hash = (hash ^ ((bits >> (i * 8)) & 0xFF)) * 0x100000001B3ull;
+        }
+    }
+
+    return hash;
+}
+
+// function values at probe points in every approximation segment,
+// changes whenever a coefficient table or a segment boundary changes
+vector<double> fingerprint_x(function<double(double)> f) {
+    vector<double> values;
+
+    for (int k = -8; k <= 8; k++) {
+        for (int j = 0; j < 16; j++) {
+            double x = ldexp(1 + j / 16., k);
+            values.push_back(f(x));
+            values.push_back(f(-x));
+        }
+    }
+    for (int k = 9; k <= 200; k += 7) {
+        values.push_back(f(ldexp(1.5, k)));
+    }
+
+    return values;
+}
+
+vector<double> fingerprint_p(function<double(double)> f) {
+    vector<double> values;
+
+    for (int k = 1; k <= 80; k++) {
+        for (int j = 0; j < 16; j++) {
+            double p = ldexp(1 + j / 16., -k - 1);
+            values.push_back(f(p));
+            values.push_back(f(1 - p));
+        }
+    }
+    values.push_back(f(ldexp(1, -1000)));
+
+    return values;
+}
+
+// 16 hex digits of the hash of grid and fingerprint
+string dataset_hash(const vector<double>& grid, const vector<double>& fingerprint) {
+    uint64_t hash = manifest_hash_basis;
+    hash = hash_values(hash, grid);
+    hash = hash_values(hash, fingerprint);
+
+    ostringstream oss;
+    oss << hex << setw(16) << setfill('0') << hash;
+
+    return oss.str();
+}
+
+// manifest lines are "filepath,hash"
+map<string, string> read_manifest(string filepath) {
+    map<string, string> manifest;
+    ifstream ifs(filepath);
+
+    string line;
+    while (getline(ifs, line)) {
+        size_t comma = line.find(',');
+        if (comma != string::npos) {
+            manifest[line.substr(0, comma)] = line.substr(comma + 1);
+        }
+    }
+
+    return manifest;
+}
+
+void write_manifest(string filepath, const map<string, string>& manifest) {
+    ofstream ofs(filepath);
+
+    for (const auto& [path, hash] : manifest) {
+        ofs << path << ',' << hash << endl;
+    }
+
+    ofs.close();
+}
+
+// the dataset has no entry, a different hash, or its file is missing
+bool manifest_stale(const map<string, string>& manifest, const string& filepath, const string& hash) {
+    auto it = manifest.find(filepath);
+
+    return it == manifest.end() || it->second != hash || !filesystem::exists(filepath);
+}
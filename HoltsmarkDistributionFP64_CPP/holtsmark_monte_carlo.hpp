@@ -0,0 +1,194 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// fused sample-and-aggregate monte carlo: each variate is drawn, mapped by f and added to an
+// accumulator without being stored, so memory is one accumulator per worker.
+// variate i comes from the philox stream (seed, 2 i), the same sequence as
+// holtsmark_sample_batch(philox_engine(seed), ...), independent of the thread count.
+// worker t takes the chunks t, t + threads, ... and the workers are merged in order, so integer
+// aggregates are bit-identical for any thread count and floating ones for a fixed thread count.
+//
+// accumulator: copyable, add(double), merge(const accumulator&) and reset(), which empties it
+// but keeps its configuration. the workers start from a reset copy of init, so prior contents
+// of init are counted once.
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_random.hpp"
+#include "holtsmark_parallel.hpp"
+
+using namespace std;
+
+// variates per chunk, the unit of work distribution
+const size_t holtsmark_mc_chunk = 65536;
+
+// count, mean, variance (welford, merged by chan et al.), min and max
+struct mc_moments {
+    uint64_t count = 0;
+    double mean = 0, m2 = 0;
+    double min = numeric_limits<double>::infinity(), max = -numeric_limits<double>::infinity();
+
+    void add(double v) {
+        count++;
+
+        double delta = v - mean;
+        mean += delta / (double)count;
+        m2 += delta * (v - mean);
+
+        min = std::min(min, v);
+        max = std::max(max, v);
+    }
+
+    void merge(const mc_moments& other) {
+        if (other.count == 0) {
+            return;
+        }
+
+        uint64_t n = count + other.count;
+        double delta = other.mean - mean;
+
+        mean += delta * ((double)other.count / (double)n);
+        m2 += other.m2 + delta * delta * ((double)count * (double)other.count / (double)n);
+        count = n;
+
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    void reset() {
+        *this = mc_moments();
+    }
+
+    double variance() const {
+        return count > 1 ? m2 / (double)(count - 1) : 0;
+    }
+};
+
+// equal width bins on [lower, upper), values outside go to underflow / overflow, nan is dropped
+struct mc_histogram {
+    double lower, upper;
+    vector<uint64_t> counts;
+    uint64_t underflow = 0, overflow = 0;
+
+    mc_histogram(double lower, double upper, size_t bins) : lower(lower), upper(upper), counts(bins, 0) {
+        assert(upper > lower && bins > 0);
+    }
+
+    void add(double v) {
+        if (v < lower) {
+            underflow++;
+        }
+        else if (v >= upper) {
+            overflow++;
+        }
+        else if (v == v) {
+            size_t bin = (size_t)((v - lower) / (upper - lower) * (double)counts.size());
+            counts[std::min(bin, counts.size() - 1)]++;
+        }
+    }
+
+    void merge(const mc_histogram& other) {
+        assert(counts.size() == other.counts.size());
+
+        for (size_t k = 0; k < counts.size(); k++) {
+            counts[k] += other.counts[k];
+        }
+        underflow += other.underflow;
+        overflow += other.overflow;
+    }
+
+    void reset() {
+        fill(counts.begin(), counts.end(), 0);
+        underflow = overflow = 0;
+    }
+
+    uint64_t total() const {
+        uint64_t n = underflow + overflow;
+        for (uint64_t k : counts) {
+            n += k;
+        }
+        return n;
+    }
+};
+
+// exceedances[k] = #{v > thresholds[k]}
+struct mc_exceedance {
+    vector<double> thresholds;
+    vector<uint64_t> exceedances;
+    uint64_t count = 0;
+
+    explicit mc_exceedance(span<const double> thresholds)
+        : thresholds(thresholds.begin(), thresholds.end()), exceedances(thresholds.size(), 0) {}
+
+    void add(double v) {
+        count++;
+
+        for (size_t k = 0; k < thresholds.size(); k++) {
+            exceedances[k] += (v > thresholds[k]) ? 1u : 0u;
+        }
+    }
+
+    void merge(const mc_exceedance& other) {
+        for (size_t k = 0; k < exceedances.size(); k++) {
+            exceedances[k] += other.exceedances[k];
+        }
+        count += other.count;
+    }
+
+    void reset() {
+        fill(exceedances.begin(), exceedances.end(), 0);
+        count = 0;
+    }
+
+    double probability(size_t k) const {
+        return count > 0 ? (double)exceedances[k] / (double)count : 0;
+    }
+};
+
+// adds f(x_i) for n variates x_i ~ holtsmark(mu, c) to init, returns the merged accumulator
+template <class Accumulator, class Func>
+Accumulator holtsmark_monte_carlo(size_t n, Func f, const Accumulator& init,
+    double mu = 0, double c = 1, uint64_t seed = 0, size_t threads = 0) {
+
+    size_t chunks = (n + holtsmark_mc_chunk - 1) / holtsmark_mc_chunk;
+    size_t workers = max((size_t)1, min(parallel_threads(threads), chunks));
+
+    Accumulator empty = init;
+    empty.reset();
+
+    vector<Accumulator> accumulators(workers, empty);
+
+    parallel_for(workers, [&](size_t t) {
+        Accumulator& acc = accumulators[t];
+
+        for (size_t chunk = t; chunk < chunks; chunk += workers) {
+            size_t i0 = chunk * holtsmark_mc_chunk, i1 = min(n, i0 + holtsmark_mc_chunk);
+
+            philox_engine engine(seed, 2 * (uint64_t)i0);
+
+            for (size_t i = i0; i < i1; i++) {
+                double u = uniform_open01(engine()) - 0.5;
+                double w = uniform_open0(engine());
+
+                acc.add(f(holtsmark_sample_transform(u, w) * c + mu));
+            }
+        }
+    }, workers);
+
+    Accumulator result = init;
+    for (size_t t = 0; t < workers; t++) {
+        result.merge(accumulators[t]);
+    }
+
+    return result;
+}
@@ -0,0 +1,222 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <numbers>
+#include <cstdint>
+#include <cassert>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_parallel.hpp"
+
+using namespace std;
+using namespace std::numbers;
+
+// structure of arrays, so that the interaction loop vectorizes
+struct nbody_points {
+    vector<double> x, y, z;
+
+    size_t size() const {
+        return x.size();
+    }
+};
+
+struct nbody_field {
+    vector<double> ex, ey, ez;
+};
+
+struct nbody_histogram_bin {
+    double lower, upper;
+    double density, expected_density;
+    double probability, expected_probability;
+};
+
+// sources swept per pass (24 KiB, stays in L1), probes per inner block, probe blocks per task
+const size_t nbody_source_block = 1024;
+const size_t nbody_probe_block = 64;
+const size_t nbody_probe_tile = 16;
+
+// uniform points in a sphere of the given radius centered at the origin
+nbody_points nbody_uniform_sphere(size_t n, double radius, uint64_t seed) {
+    mt19937_64 engine(seed);
+    uniform_real_distribution<double> uniform(-1, 1);
+
+    nbody_points points;
+    points.x.reserve(n);
+    points.y.reserve(n);
+    points.z.reserve(n);
+
+    while (points.size() < n) {
+        double x = uniform(engine), y = uniform(engine), z = uniform(engine);
+
+        if (x * x + y * y + z * z > 1) {
+            continue;
+        }
+
+        points.x.push_back(x * radius);
+        points.y.push_back(y * radius);
+        points.z.push_back(z * radius);
+    }
+
+    return points;
+}
+
+// holtsmark scale of a single field component for unit charges of number density n:
+// c = 2 pi (4 n / 15)^(2/3)
+double nbody_holtsmark_scale(double density) {
+    return 2 * pi * pow(4 * density / 15, 2. / 3.);
+}
+
+double nbody_holtsmark_scale(size_t sources, double radius) {
+    double density = sources / (4. / 3. * pi * cube(radius));
+
+    return nbody_holtsmark_scale(density);
+}
+
+// field of unit point sources, sum (r_probe - r_source) / |r_probe - r_source|^3
+// tiled over probes x sources: each task owns a tile of probe blocks and sweeps every source block
+// over all probe blocks of the tile, so a source block is loaded once per tile and then reused
+// from L1. sources are still added to every probe in index order, independent of the threads.
+nbody_field nbody_evaluate_field(const nbody_points& sources, const nbody_points& probes, size_t threads = 0) {
+    size_t n = sources.size(), m = probes.size();
+
+    nbody_field field;
+    field.ex.assign(m, 0);
+    field.ey.assign(m, 0);
+    field.ez.assign(m, 0);
+
+    size_t tile_size = nbody_probe_block * nbody_probe_tile;
+    size_t tiles = (m + tile_size - 1) / tile_size;
+
+    parallel_for(tiles, [&](size_t tile) {
+        size_t t0 = tile * tile_size, t1 = min(m, t0 + tile_size);
+
+        for (size_t s0 = 0; s0 < n; s0 += nbody_source_block) {
+            size_t s1 = min(n, s0 + nbody_source_block);
+
+            for (size_t p0 = t0; p0 < t1; p0 += nbody_probe_block) {
+                size_t pn = min(t1 - p0, nbody_probe_block);
+
+                const double* px = probes.x.data() + p0;
+                const double* py = probes.y.data() + p0;
+                const double* pz = probes.z.data() + p0;
+
+                double ex[nbody_probe_block], ey[nbody_probe_block], ez[nbody_probe_block];
+                copy_n(field.ex.begin() + p0, pn, ex);
+                copy_n(field.ey.begin() + p0, pn, ey);
+                copy_n(field.ez.begin() + p0, pn, ez);
+
+                for (size_t s = s0; s < s1; s++) {
+                    double sx = sources.x[s], sy = sources.y[s], sz = sources.z[s];
+
+                    for (size_t p = 0; p < pn; p++) {
+                        double dx = px[p] - sx, dy = py[p] - sy, dz = pz[p] - sz;
+                        double r2 = dx * dx + dy * dy + dz * dz;
+                        double w = 1 / (r2 * sqrt(r2));
+
+                        ex[p] += dx * w;
+                        ey[p] += dy * w;
+                        ez[p] += dz * w;
+                    }
+                }
+
+                copy_n(ex, pn, field.ex.begin() + p0);
+                copy_n(ey, pn, field.ey.begin() + p0);
+                copy_n(ez, pn, field.ez.begin() + p0);
+            }
+        }
+    }, threads);
+
+    return field;
+}
+
+// places sources uniformly in a sphere and returns all field components at probes
+// uniformly placed in the inner sphere, divided by the holtsmark scale.
+// the mean field of the uniformly charged sphere, (sources / radius^3) r_probe,
+// is subtracted (neutralizing background).
+// probe_radius < radius keeps the boundary correction small, while it should still span
+// many interparticle spacings so that the probes are nearly independent (e.g. radius / 3).
+vector<double> nbody_normalized_field(
+    size_t sources, size_t probes, double radius, double probe_radius, uint64_t seed, size_t threads = 0) {
+
+    nbody_points source_points = nbody_uniform_sphere(sources, radius, seed);
+    nbody_points probe_points = nbody_uniform_sphere(probes, probe_radius, seed ^ 0x9E3779B97F4A7C15ull);
+
+    nbody_field field = nbody_evaluate_field(source_points, probe_points, threads);
+
+    double c_inv = 1 / nbody_holtsmark_scale(sources, radius);
+    double background = sources / cube(radius);
+
+    vector<double> normalized;
+    normalized.reserve(probes * 3);
+
+    for (size_t i = 0; i < probes; i++) {
+        normalized.push_back((field.ex[i] - background * probe_points.x[i]) * c_inv);
+        normalized.push_back((field.ey[i] - background * probe_points.y[i]) * c_inv);
+        normalized.push_back((field.ez[i] - background * probe_points.z[i]) * c_inv);
+    }
+
+    return normalized;
+}
+
+// empirical density and bin probability against holtsmark_pdf and holtsmark_cdf,
+// empty when there are no samples
+vector<nbody_histogram_bin> nbody_histogram(const vector<double>& samples, double xmin, double xmax, size_t bins) {
+    assert(bins > 0 && xmin < xmax);
+
+    if (samples.empty()) {
+        return {};
+    }
+
+    vector<size_t> counts(bins, 0);
+
+    double h = (xmax - xmin) / bins;
+
+    for (double x : samples) {
+        if (!(x >= xmin && x < xmax)) {
+            continue;
+        }
+
+        size_t index = min(bins - 1, (size_t)((x - xmin) / h));
+
+        counts[index]++;
+    }
+
+    vector<nbody_histogram_bin> histogram(bins);
+
+    for (size_t i = 0; i < bins; i++) {
+        double lower = xmin + i * h, upper = xmin + (i + 1) * h;
+
+        double probability = (double)counts[i] / samples.size();
+        double expected_probability = holtsmark_cdf(upper) - holtsmark_cdf(lower);
+
+        histogram[i] = nbody_histogram_bin{
+            lower, upper,
+            probability / h, holtsmark_pdf((lower + upper) / 2),
+            probability, expected_probability
+        };
+    }
+
+    return histogram;
+}
+
+// kolmogorov-smirnov statistic of the samples against holtsmark_cdf
+double nbody_ks_statistic(vector<double> samples) {
+    sort(samples.begin(), samples.end());
+
+    double n = (double)samples.size(), d = 0;
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        double cdf = holtsmark_cdf(samples[i]);
+
+        d = max(d, max(abs((i + 1) / n - cdf), abs(cdf - i / n)));
+    }
+
+    return d;
+}
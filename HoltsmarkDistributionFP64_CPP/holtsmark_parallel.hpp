@@ -0,0 +1,165 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <algorithm>
+
+using namespace std;
+
+size_t parallel_threads(size_t threads = 0) {
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+
+    return threads;
+}
+
+// calls func(i) for i in [0, tasks), tasks are handed out dynamically.
+// func must only write to state owned by task i.
+template <class Func>
+void parallel_for(size_t tasks, Func func, size_t threads = 0) {
+    threads = min(parallel_threads(threads), tasks);
+
+    if (threads <= 1) {
+        for (size_t i = 0; i < tasks; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    atomic<size_t> next = 0;
+    vector<thread> workers;
+    workers.reserve(threads);
+
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for (size_t i; (i = next.fetch_add(1, memory_order_relaxed)) < tasks;) {
+                func(i);
+            }
+        });
+    }
+
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// persistent workers for repeated parallel loops: no thread creation and no allocation per run.
+// run is called by one thread at a time, which takes part in the work and returns when every task is done.
+class parallel_pool {
+public:
+    explicit parallel_pool(size_t threads = 0) {
+        threads = parallel_threads(threads);
+
+        for (size_t t = 1; t < threads; t++) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    parallel_pool(const parallel_pool&) = delete;
+    parallel_pool& operator=(const parallel_pool&) = delete;
+
+    ~parallel_pool() {
+        {
+            lock_guard<mutex> lock(job_mutex);
+            stopping = true;
+        }
+        job_ready.notify_all();
+
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    size_t threads() const {
+        return workers.size() + 1;
+    }
+
+    // calls func(i) for i in [0, tasks), tasks are handed out dynamically
+    template <class Func>
+    void run(size_t tasks, Func& func) {
+        if (workers.empty() || tasks <= 1) {
+            for (size_t i = 0; i < tasks; i++) {
+                func(i);
+            }
+            return;
+        }
+
+        {
+            lock_guard<mutex> lock(job_mutex);
+
+            job_call = [](void* context, size_t i) { (*static_cast<Func*>(context))(i); };
+            job_context = &func;
+            job_tasks = tasks;
+            next.store(0, memory_order_relaxed);
+            pending = workers.size();
+            generation++;
+        }
+        job_ready.notify_all();
+
+        execute();
+
+        unique_lock<mutex> lock(job_mutex);
+        job_done.wait(lock, [&]() { return pending == 0; });
+    }
+
+private:
+    vector<thread> workers;
+
+    mutex job_mutex;
+    condition_variable job_ready, job_done;
+    bool stopping = false;
+    uint64_t generation = 0;
+    size_t pending = 0;
+
+    void (*job_call)(void*, size_t) = nullptr;
+    void* job_context = nullptr;
+    size_t job_tasks = 0;
+    atomic<size_t> next = 0;
+
+    void execute() {
+        for (size_t i; (i = next.fetch_add(1, memory_order_relaxed)) < job_tasks;) {
+            job_call(job_context, i);
+        }
+    }
+
+    void work() {
+        uint64_t seen = 0;
+
+        for (;;) {
+            {
+                unique_lock<mutex> lock(job_mutex);
+                job_ready.wait(lock, [&]() { return stopping || generation != seen; });
+
+                if (stopping) {
+                    return;
+                }
+
+                seen = generation;
+            }
+
+            execute();
+
+            {
+                lock_guard<mutex> lock(job_mutex);
+                if (--pending == 0) {
+                    job_done.notify_one();
+                }
+            }
+        }
+    }
+};
+
+template <class Func>
+void parallel_for(size_t tasks, Func func, parallel_pool& pool) {
+    pool.run(tasks, func);
+}
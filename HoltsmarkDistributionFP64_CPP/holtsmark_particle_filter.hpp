@@ -0,0 +1,194 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_parallel.hpp"
+#include "holtsmark_reduction.hpp"
+
+using namespace std;
+
+// particles per parallel task
+const size_t holtsmark_pf_block = 4096;
+
+// buffers and worker threads reused between filter steps, buffers are sized once by resize.
+// a step then neither allocates nor creates threads.
+struct holtsmark_pf_workspace {
+    // normalized weights, and their inclusive cumulative sums used by resampling
+    vector<double> log_weights, weights, cdf;
+    // per holtsmark_pf_block, also the task sums of the normalization (reproducible_sum_tasks(n) <= blocks)
+    vector<double> block_max, block_sums;
+    vector<size_t> ancestors;
+
+    unique_ptr<parallel_pool> pool;
+
+    explicit holtsmark_pf_workspace(size_t threads = 0) : pool(make_unique<parallel_pool>(threads)) {}
+
+    void resize(size_t n) {
+        size_t blocks = (n + holtsmark_pf_block - 1) / holtsmark_pf_block;
+
+        log_weights.resize(n);
+        weights.resize(n);
+        cdf.resize(n);
+        block_max.resize(blocks);
+        block_sums.resize(max(blocks, reproducible_sum_tasks(n)));
+        ancestors.resize(n);
+    }
+};
+
+// log_weights[i] = log p(z; h(particles[i]), c), returns the maximum log-weight (-inf without particles)
+template <class Particle, class Measurement>
+double holtsmark_pf_log_weights(span<const Particle> particles, Measurement h, double z, double c,
+    holtsmark_pf_workspace& ws) {
+
+    size_t n = particles.size(), blocks = (n + holtsmark_pf_block - 1) / holtsmark_pf_block;
+
+    if (n == 0) {
+        return -numeric_limits<double>::infinity();
+    }
+
+    double c_inv = 1 / c, log_c = log(c);
+
+    parallel_for(blocks, [&](size_t block) {
+        size_t i0 = block * holtsmark_pf_block, i1 = min(n, i0 + holtsmark_pf_block);
+
+        double m = -numeric_limits<double>::infinity();
+
+        for (size_t i = i0; i < i1; i++) {
+            double lw = holtsmark_logpdf((z - h(particles[i])) * c_inv) - log_c;
+
+            ws.log_weights[i] = lw;
+            m = max(m, lw);
+        }
+
+        ws.block_max[block] = m;
+    }, *ws.pool);
+
+    return *max_element(ws.block_max.begin(), ws.block_max.begin() + blocks);
+}
+
+// weights[i] = exp(log_weights[i] - max) / sum, log-sum-exp with the maximum from holtsmark_pf_log_weights.
+// returns log sum_i exp(log_weights[i]), the log-likelihood increment of the step (without the 1/n factor).
+// if every weight underflows, the weights are reset to uniform.
+double holtsmark_pf_normalize(size_t n, double max_log_weight, holtsmark_pf_workspace& ws) {
+    if (!isfinite(max_log_weight)) {
+        fill(ws.weights.begin(), ws.weights.begin() + n, 1.0 / n);
+
+        return max_log_weight;
+    }
+
+    double sum = reproducible_sum(n, [&](size_t i0, span<double> buffer) {
+        for (size_t i = 0; i < buffer.size(); i++) {
+            double w = exp(ws.log_weights[i0 + i] - max_log_weight);
+
+            ws.weights[i0 + i] = w;
+            buffer[i] = w;
+        }
+    }, span<double>(ws.block_sums), *ws.pool);
+
+    double sum_inv = 1 / sum;
+    size_t blocks = (n + holtsmark_pf_block - 1) / holtsmark_pf_block;
+
+    parallel_for(blocks, [&](size_t block) {
+        size_t i0 = block * holtsmark_pf_block, i1 = min(n, i0 + holtsmark_pf_block);
+
+        for (size_t i = i0; i < i1; i++) {
+            ws.weights[i] *= sum_inv;
+        }
+    }, *ws.pool);
+
+    return max_log_weight + log(sum);
+}
+
+// systematic resampling of normalized weights, u0 in [0, 1), the weights are kept.
+// ancestors[j] = min { i : cumulative weight through i > (u0 + j) / n }
+void holtsmark_pf_resample(size_t n, double u0, holtsmark_pf_workspace& ws) {
+    size_t blocks = (n + holtsmark_pf_block - 1) / holtsmark_pf_block;
+
+    if (n == 0) {
+        return;
+    }
+
+    // inclusive cumulative sums of the weights, block local first, then shifted by the block offsets
+    parallel_for(blocks, [&](size_t block) {
+        size_t i0 = block * holtsmark_pf_block, i1 = min(n, i0 + holtsmark_pf_block);
+
+        double s = 0;
+        for (size_t i = i0; i < i1; i++) {
+            s += ws.weights[i];
+            ws.cdf[i] = s;
+        }
+
+        ws.block_sums[block] = s;
+    }, *ws.pool);
+
+    double offset = 0;
+    for (size_t block = 0; block < blocks; block++) {
+        double s = ws.block_sums[block];
+
+        ws.block_sums[block] = offset;
+        offset += s;
+    }
+
+    double scale = 1 / offset;
+
+    parallel_for(blocks, [&](size_t block) {
+        size_t i0 = block * holtsmark_pf_block, i1 = min(n, i0 + holtsmark_pf_block);
+
+        for (size_t i = i0; i < i1; i++) {
+            ws.cdf[i] = (ws.cdf[i] + ws.block_sums[block]) * scale;
+        }
+    }, *ws.pool);
+
+    // each task locates its first ancestor by binary search, then walks forward
+    parallel_for(blocks, [&](size_t block) {
+        size_t j0 = block * holtsmark_pf_block, j1 = min(n, j0 + holtsmark_pf_block);
+
+        const double* cdf = ws.cdf.data();
+
+        size_t i = upper_bound(cdf, cdf + n, (u0 + j0) / n) - cdf;
+
+        for (size_t j = j0; j < j1; j++) {
+            double position = (u0 + j) / n;
+
+            while (i < n - 1 && cdf[i] <= position) {
+                i++;
+            }
+
+            ws.ancestors[j] = min(i, n - 1);
+        }
+    }, *ws.pool);
+}
+
+// one filter step: log-weights, normalization into ws.weights and resampling into ws.ancestors.
+// returns the log-likelihood increment log (1/n sum_i p(z; h(particles[i]), c)), -inf without particles.
+template <class Particle, class Measurement>
+double holtsmark_pf_step(span<const Particle> particles, Measurement h, double z, double c, double u0,
+    holtsmark_pf_workspace& ws) {
+
+    size_t n = particles.size();
+
+    if (n == 0) {
+        return -numeric_limits<double>::infinity();
+    }
+
+    if (ws.ancestors.size() != n) {
+        ws.resize(n);
+    }
+
+    double max_log_weight = holtsmark_pf_log_weights(particles, h, z, c, ws);
+    double log_sum = holtsmark_pf_normalize(n, max_log_weight, ws);
+
+    holtsmark_pf_resample(n, u0, ws);
+
+    return log_sum - log((double)n);
+}
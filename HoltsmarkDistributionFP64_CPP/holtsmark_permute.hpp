@@ -0,0 +1,236 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// mixed-segment kernel without partitioning: the coefficients are transposed by degree,
+// table[j][k] = coefficient j of segment k, so every horner step picks the coefficient of each
+// lane by its segment index. with AVX-512 the 16 entries of a degree live in two registers and
+// are selected by vpermi2pd, otherwise the lookup is a scalar load.
+// results are bit-identical to holtsmark_pdf / holtsmark_cdf.
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_batch.hpp"
+#include "holtsmark_bucketed.hpp"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// segments per table, padded so that a degree fills two 8 lane registers
+const size_t holtsmark_permute_segments = 16;
+
+struct transposed_pade_table {
+    size_t terms;
+    int limit_index;
+    alignas(64) double offset[holtsmark_permute_segments];
+    alignas(64) double numer[holtsmark_pade_max_terms][holtsmark_permute_segments];
+    alignas(64) double denom[holtsmark_pade_max_terms][holtsmark_permute_segments];
+};
+
+transposed_pade_table to_transposed_table(const vector<padded_pade_segment>& segments, int limit_index) {
+    assert(segments.size() <= holtsmark_permute_segments);
+
+    transposed_pade_table table{};
+    table.limit_index = limit_index;
+
+    for (size_t k = 0; k < segments.size(); k++) {
+        table.terms = max(table.terms, segments[k].terms);
+        table.offset[k] = segments[k].offset;
+
+        for (size_t j = 0; j < holtsmark_pade_max_terms; j++) {
+            table.numer[j][k] = segments[k].numer[j];
+            table.denom[j][k] = segments[k].denom[j];
+        }
+    }
+
+    return table;
+}
+
+const transposed_pade_table& holtsmark_pdf_transposed_table() {
+    static const transposed_pade_table table =
+        to_transposed_table(holtsmark_pdf_padded_segments(), holtsmark_pdf_limit_index);
+
+    return table;
+}
+
+const transposed_pade_table& holtsmark_cdf_transposed_table() {
+    static const transposed_pade_table table =
+        to_transposed_table(holtsmark_cdf_padded_segments(), holtsmark_cdf_limit_index);
+
+    return table;
+}
+
+// pade value of one element on segment k, s = |x| - offset or |x|^-3/2 on the limit segment
+double transposed_pade(const transposed_pade_table& table, int k, double s) {
+    double n = table.numer[table.terms - 1][k], d = table.denom[table.terms - 1][k];
+
+    for (size_t j = table.terms - 1; j-- > 0;) {
+        n = n * s + table.numer[j][k];
+        d = d * s + table.denom[j][k];
+    }
+
+    return n / d;
+}
+
+double holtsmark_pdf_permute(const transposed_pade_table& table, double v) {
+    double a = abs(v);
+    int k = holtsmark_pdf_segment_index(a);
+
+    if (k < table.limit_index) {
+        return transposed_pade(table, k, a - table.offset[k]);
+    }
+
+    return transposed_pade(table, k, pow_m1p5(a)) * pow_m2p5(a);
+}
+
+double holtsmark_cdf_permute(const transposed_pade_table& table, double v, bool complementary) {
+    bool inversion = (v <= 0) ^ complementary;
+
+    double a = abs(v);
+    int k = holtsmark_cdf_segment_index(a);
+
+    double p;
+    if (k < table.limit_index) {
+        p = transposed_pade(table, k, a - table.offset[k]);
+    }
+    else {
+        double u = pow_m1p5(a);
+        p = transposed_pade(table, k, u) * u;
+    }
+
+    return inversion ? p : 1 - p;
+}
+
+#if defined(__AVX512F__)
+
+// ceil(log2(a)) clamped below at 0, a >= 0
+inline __m512i permute_exponent_ceil(__m512d a) {
+    const __m512i mantissa = _mm512_set1_epi64(0x000FFFFFFFFFFFFFll);
+
+    __m512i bits = _mm512_castpd_si512(a);
+    __m512i e = _mm512_sub_epi64(_mm512_srli_epi64(bits, 52), _mm512_set1_epi64(1023));
+    e = _mm512_mask_add_epi64(e, _mm512_test_epi64_mask(bits, mantissa), e, _mm512_set1_epi64(1));
+
+    return _mm512_max_epi64(e, _mm512_setzero_si512());
+}
+
+// rational of 8 lanes with per-lane segment index k
+inline __m512d permute_pade(const transposed_pade_table& table, __m512i k, __m512d s) {
+    size_t j = table.terms - 1;
+
+    __m512d n = _mm512_permutex2var_pd(_mm512_load_pd(table.numer[j]), k, _mm512_load_pd(table.numer[j] + 8));
+    __m512d d = _mm512_permutex2var_pd(_mm512_load_pd(table.denom[j]), k, _mm512_load_pd(table.denom[j] + 8));
+
+    while (j-- > 0) {
+        __m512d cn = _mm512_permutex2var_pd(_mm512_load_pd(table.numer[j]), k, _mm512_load_pd(table.numer[j] + 8));
+        __m512d cd = _mm512_permutex2var_pd(_mm512_load_pd(table.denom[j]), k, _mm512_load_pd(table.denom[j] + 8));
+
+        n = _mm512_add_pd(_mm512_mul_pd(n, s), cn);
+        d = _mm512_add_pd(_mm512_mul_pd(d, s), cd);
+    }
+
+    return _mm512_div_pd(n, d);
+}
+
+// k, pade argument s and, on the limit lanes, r = 1 / a
+inline __m512d permute_argument(const transposed_pade_table& table, __m512i k, __m512d a, __m512d& r) {
+    __mmask8 limit = _mm512_cmpeq_epi64_mask(k, _mm512_set1_epi64(table.limit_index));
+
+    __m512d offset = _mm512_permutex2var_pd(_mm512_load_pd(table.offset), k, _mm512_load_pd(table.offset + 8));
+
+    r = _mm512_div_pd(_mm512_set1_pd(1), a);
+    __m512d u = _mm512_mul_pd(r, _mm512_sqrt_pd(r));
+
+    return _mm512_mask_blend_pd(limit, _mm512_sub_pd(a, offset), u);
+}
+
+#endif
+
+void holtsmark_pdf_permute_batch(span<const double> x, span<double> y, double mu = 0, double c = 1) {
+    assert(x.size() == y.size());
+
+    const transposed_pade_table& table = holtsmark_pdf_transposed_table();
+
+    double c_inv = 1 / c;
+
+    size_t i = 0;
+
+#if defined(__AVX512F__)
+    const __m512d abs_mask = _mm512_castsi512_pd(_mm512_set1_epi64(0x7FFFFFFFFFFFFFFFll));
+
+    for (; i + 8 <= x.size(); i += 8) {
+        __m512d v = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(&x[i]), _mm512_set1_pd(mu)), _mm512_set1_pd(c_inv));
+        __m512d a = _mm512_and_pd(v, abs_mask);
+
+        __mmask8 inner = _mm512_cmp_pd_mask(a, _mm512_set1_pd(64), _CMP_LE_OQ);
+        __m512i k = _mm512_mask_mov_epi64(_mm512_set1_epi64(table.limit_index), inner, permute_exponent_ceil(a));
+
+        __m512d r;
+        __m512d s = permute_argument(table, k, a, r);
+        __m512d p = permute_pade(table, k, s);
+
+        __m512d tail = _mm512_mul_pd(_mm512_mul_pd(r, r), _mm512_sqrt_pd(r));
+        p = _mm512_mask_blend_pd(inner, _mm512_mul_pd(p, tail), p);
+
+        _mm512_storeu_pd(&y[i], _mm512_mul_pd(p, _mm512_set1_pd(c_inv)));
+    }
+#endif
+
+    for (; i < x.size(); i++) {
+        y[i] = holtsmark_pdf_permute(table, (x[i] - mu) * c_inv) * c_inv;
+    }
+}
+
+void holtsmark_cdf_permute_batch(span<const double> x, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+    assert(x.size() == y.size());
+
+    const transposed_pade_table& table = holtsmark_cdf_transposed_table();
+
+    double c_inv = 1 / c;
+
+    size_t i = 0;
+
+#if defined(__AVX512F__)
+    const __m512d abs_mask = _mm512_castsi512_pd(_mm512_set1_epi64(0x7FFFFFFFFFFFFFFFll));
+    const __m512d one = _mm512_set1_pd(1);
+
+    for (; i + 8 <= x.size(); i += 8) {
+        __m512d v = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(&x[i]), _mm512_set1_pd(mu)), _mm512_set1_pd(c_inv));
+        __m512d a = _mm512_and_pd(v, abs_mask);
+
+        __mmask8 inner = _mm512_cmp_pd_mask(a, _mm512_set1_pd(64), _CMP_LE_OQ);
+        __mmask8 center = _mm512_cmp_pd_mask(a, _mm512_set1_pd(0.5), _CMP_LE_OQ);
+
+        __m512i k = _mm512_add_epi64(permute_exponent_ceil(a), _mm512_set1_epi64(1));
+        k = _mm512_mask_mov_epi64(k, center, _mm512_setzero_si512());
+        k = _mm512_mask_mov_epi64(_mm512_set1_epi64(table.limit_index), inner, k);
+
+        __m512d r;
+        __m512d s = permute_argument(table, k, a, r);
+        __m512d p = permute_pade(table, k, s);
+
+        p = _mm512_mask_blend_pd(inner, _mm512_mul_pd(p, s), p);
+
+        __mmask8 inversion = _mm512_cmp_pd_mask(v, _mm512_setzero_pd(), _CMP_LE_OQ);
+        if (complementary) {
+            inversion = (__mmask8)~inversion;
+        }
+
+        _mm512_storeu_pd(&y[i], _mm512_mask_blend_pd(inversion, _mm512_sub_pd(one, p), p));
+    }
+#endif
+
+    for (; i < x.size(); i++) {
+        y[i] = holtsmark_cdf_permute(table, (x[i] - mu) * c_inv, complementary);
+    }
+}
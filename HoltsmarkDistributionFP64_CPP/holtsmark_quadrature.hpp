@@ -0,0 +1,255 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// quadrature for expectations E[g(X)], X ~ holtsmark(0, 1).
+// the body is split at break points, each interval gets a gauss-legendre rule with the pdf in the weights.
+// the tails |x| > T use x = T exp(s / 1.5): pdf(x) x^(5/2) is smooth in s and dx pdf(x) ~ exp(-s) ds,
+// so a gauss-laguerre rule absorbs the x^-5/2 decay, including log x growth of g.
+
+#pragma once
+
+#include <span>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <numbers>
+#include <algorithm>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_batch.hpp"
+
+using namespace std;
+using namespace std::numbers;
+
+struct quadrature_rule {
+    vector<double> nodes, weights;
+};
+
+// nodes and weights on [-1, 1], newton iteration on the legendre recurrence
+quadrature_rule gauss_legendre(size_t n) {
+    quadrature_rule rule{ vector<double>(n), vector<double>(n) };
+
+    for (size_t i = 0; i < (n + 1) / 2; i++) {
+        double x = cos(pi * ((double)i + 0.75) / ((double)n + 0.5)), dp = 1;
+
+        for (int iter = 0; iter < 100; iter++) {
+            double p0 = 1, p1 = 0;
+            for (size_t j = 1; j <= n; j++) {
+                double p2 = p1;
+                p1 = p0;
+                p0 = ((2 * (double)j - 1) * x * p1 - ((double)j - 1) * p2) / (double)j;
+            }
+
+            dp = (double)n * (x * p0 - p1) / (x * x - 1);
+
+            double dx = p0 / dp;
+            x -= dx;
+
+            if (abs(dx) <= 1e-16) {
+                break;
+            }
+        }
+
+        double w = 2 / ((1 - x * x) * dp * dp);
+
+        rule.nodes[i] = -x;
+        rule.nodes[n - 1 - i] = x;
+        rule.weights[i] = rule.weights[n - 1 - i] = w;
+    }
+
+    return rule;
+}
+
+// nodes and weights for the weight exp(-x) on [0, inf)
+quadrature_rule gauss_laguerre(size_t n) {
+    quadrature_rule rule{ vector<double>(n), vector<double>(n) };
+
+    double x = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        // initial guesses of numerical recipes, gaulag
+        if (i == 0) {
+            x = 3 / (1 + 2.4 * (double)n);
+        }
+        else if (i == 1) {
+            x += 15 / (1 + 2.5 * (double)n);
+        }
+        else {
+            double ai = (double)i - 1;
+            x += (1 + 2.55 * ai) / (1.9 * ai) * (x - rule.nodes[i - 2]);
+        }
+
+        double p1 = 0, p2 = 0, dp = 1;
+
+        for (int iter = 0; iter < 100; iter++) {
+            p1 = 1;
+            p2 = 0;
+            for (size_t j = 0; j < n; j++) {
+                double p3 = p2;
+                p2 = p1;
+                p1 = ((2 * (double)j + 1 - x) * p2 - (double)j * p3) / ((double)j + 1);
+            }
+
+            dp = (double)n * (p1 - p2) / x;
+
+            double dx = p1 / dp;
+            x -= dx;
+
+            if (abs(dx) <= 1e-15 * max(1.0, x)) {
+                break;
+            }
+        }
+
+        rule.nodes[i] = x;
+        rule.weights[i] = -1 / (dp * (double)n * p2);
+    }
+
+    return rule;
+}
+
+// 0, +-1, +-2, +-4, ..., +-64, continued geometrically while below limit
+vector<double> holtsmark_segment_breaks(double limit = 64) {
+    vector<double> breaks = { 0 };
+
+    for (double x = 1; x <= max(64.0, limit); x *= 2) {
+        breaks.push_back(x);
+        breaks.push_back(-x);
+    }
+
+    sort(breaks.begin(), breaks.end());
+
+    return breaks;
+}
+
+// make(n) computed once per n, one cache per call site (lambda type)
+template <class Make>
+const auto& cached_by_order(size_t n, Make make) {
+    using value_type = decltype(make(n));
+
+    static mutex values_mutex;
+    static map<size_t, value_type> values;
+
+    lock_guard<mutex> lock(values_mutex);
+
+    auto it = values.find(n);
+    if (it == values.end()) {
+        it = values.emplace(n, make(n)).first;
+    }
+
+    return it->second;
+}
+
+const quadrature_rule& gauss_legendre_cached(size_t n) {
+    return cached_by_order(n, [](size_t n) { return gauss_legendre(n); });
+}
+
+const quadrature_rule& gauss_laguerre_cached(size_t n) {
+    return cached_by_order(n, [](size_t n) { return gauss_laguerre(n); });
+}
+
+// legendre nodes of [a, b] with the pdf folded into the weights, order <= 64
+void holtsmark_append_interval(quadrature_rule& rule, double a, double b, const quadrature_rule& legendre) {
+    double center = (a + b) / 2, half = (b - a) / 2;
+
+    size_t i0 = rule.nodes.size(), n = legendre.nodes.size();
+
+    for (size_t i = 0; i < n; i++) {
+        rule.nodes.push_back(center + half * legendre.nodes[i]);
+        rule.weights.push_back(half * legendre.weights[i]);
+    }
+
+    double pdf[64];
+    assert(n <= size(pdf));
+
+    holtsmark_pdf_batch(span<const double>(rule.nodes).subspan(i0, n), span<double>(pdf, n));
+
+    for (size_t i = 0; i < n; i++) {
+        rule.weights[i0 + i] *= pdf[i];
+    }
+}
+
+// tail |x| > |tail| on the side of tail, x = |tail| exp(s / 1.5)
+void holtsmark_append_tail(quadrature_rule& rule, double tail, const quadrature_rule& laguerre) {
+    double t = abs(tail), scale = 1 / (1.5 * t * sqrt(t));
+
+    for (size_t i = 0; i < laguerre.nodes.size(); i++) {
+        double x = t * exp(laguerre.nodes[i] / 1.5);
+
+        rule.nodes.push_back(copysign(x, tail));
+        rule.weights.push_back(laguerre.weights[i] * holtsmark_pdf(x) * x * x * sqrt(x) * scale);
+    }
+}
+
+// sum_i weights[i] g(nodes[i]) ~ E[g(X)].
+// breaks: ascending, breaks.front() <= -64 and breaks.back() >= 64, adjacent breaks should not
+// differ by more than a factor 2 outside [-1, 1] for full accuracy.
+// the base rules, the intervals of holtsmark_segment_breaks() and the tails beyond +-64 are
+// cached per order, so only other intervals and tails evaluate the pdf.
+quadrature_rule holtsmark_expectation_rule(span<const double> breaks, size_t order = 16, size_t tail_order = 24) {
+    assert(breaks.size() >= 2 && breaks.front() <= -64 && breaks.back() >= 64);
+
+    static const vector<double> standard_breaks = holtsmark_segment_breaks();
+
+    const quadrature_rule& legendre = gauss_legendre_cached(order);
+    const quadrature_rule& laguerre = gauss_laguerre_cached(tail_order);
+
+    const vector<quadrature_rule>& standard_intervals = cached_by_order(order, [](size_t n) {
+        vector<quadrature_rule> intervals(standard_breaks.size() - 1);
+
+        for (size_t k = 0; k + 1 < standard_breaks.size(); k++) {
+            holtsmark_append_interval(intervals[k], standard_breaks[k], standard_breaks[k + 1], gauss_legendre_cached(n));
+        }
+
+        return intervals;
+    });
+
+    // upper tail, then lower tail
+    const quadrature_rule& standard_tails = cached_by_order(tail_order, [](size_t n) {
+        quadrature_rule tails;
+
+        holtsmark_append_tail(tails, 64, gauss_laguerre_cached(n));
+        holtsmark_append_tail(tails, -64, gauss_laguerre_cached(n));
+
+        return tails;
+    });
+
+    size_t capacity = (breaks.size() - 1) * order + 2 * tail_order;
+
+    quadrature_rule rule;
+    rule.nodes.reserve(capacity);
+    rule.weights.reserve(capacity);
+
+    for (size_t k = 0; k + 1 < breaks.size(); k++) {
+        double a = breaks[k], b = breaks[k + 1];
+
+        if (!(b > a)) {
+            continue;
+        }
+
+        auto it = lower_bound(standard_breaks.begin(), standard_breaks.end(), a);
+
+        if (it + 1 < standard_breaks.end() && it[0] == a && it[1] == b) {
+            const quadrature_rule& cached = standard_intervals[it - standard_breaks.begin()];
+
+            rule.nodes.insert(rule.nodes.end(), cached.nodes.begin(), cached.nodes.end());
+            rule.weights.insert(rule.weights.end(), cached.weights.begin(), cached.weights.end());
+        }
+        else {
+            holtsmark_append_interval(rule, a, b, legendre);
+        }
+    }
+
+    if (breaks.front() == -64 && breaks.back() == 64) {
+        rule.nodes.insert(rule.nodes.end(), standard_tails.nodes.begin(), standard_tails.nodes.end());
+        rule.weights.insert(rule.weights.end(), standard_tails.weights.begin(), standard_tails.weights.end());
+    }
+    else {
+        holtsmark_append_tail(rule, breaks.back(), laguerre);
+        holtsmark_append_tail(rule, breaks.front(), laguerre);
+    }
+
+    return rule;
+}
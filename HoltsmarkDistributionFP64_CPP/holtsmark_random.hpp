@@ -0,0 +1,93 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+using namespace std;
+
+// counter-based generator, philox4x32-10 (Salmon et al., SC11).
+// output i of stream key is a pure function of (key, i), so streams can be split
+// by key and positioned by seek without generating the skipped values.
+// satisfies uniform_random_bit_generator with 64-bit results, two per block.
+class philox_engine {
+public:
+    using result_type = uint64_t;
+
+    philox_engine(uint64_t key = 0, uint64_t position = 0) : key(key) {
+        seek(position);
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        if (index >= 2) {
+            block = generate(key, counter++);
+            index = 0;
+        }
+
+        uint64_t r = ((uint64_t)block[index * 2] << 32) | block[index * 2 + 1];
+        index++;
+
+        return r;
+    }
+
+    // moves to output number position of this stream
+    void seek(uint64_t position) {
+        counter = position / 2;
+        block = generate(key, counter++);
+        index = position % 2;
+    }
+
+    void discard(uint64_t n) {
+        seek(tell() + n);
+    }
+
+    uint64_t tell() const {
+        return (counter - 1) * 2 + index;
+    }
+
+    uint64_t stream() const {
+        return key;
+    }
+
+    static array<uint32_t, 4> generate(uint64_t key, uint64_t counter) {
+        return philox4x32_10({ (uint32_t)counter, (uint32_t)(counter >> 32), 0u, 0u }, (uint32_t)key, (uint32_t)(key >> 32));
+    }
+
+    // the bare block function on a 128-bit counter, as in the reference implementation
+    static array<uint32_t, 4> philox4x32_10(array<uint32_t, 4> x, uint32_t k0, uint32_t k1) {
+        const uint32_t m0 = 0xD2511F53u, m1 = 0xCD9E8D57u;
+        const uint32_t w0 = 0x9E3779B9u, w1 = 0xBB67AE85u;
+
+        for (int round = 0; round < 10; round++) {
+            uint64_t p0 = (uint64_t)m0 * x[0], p1 = (uint64_t)m1 * x[2];
+
+            x = {
+                (uint32_t)(p1 >> 32) ^ x[1] ^ k0, (uint32_t)p1,
+                (uint32_t)(p0 >> 32) ^ x[3] ^ k1, (uint32_t)p0
+            };
+
+            k0 += w0;
+            k1 += w1;
+        }
+
+        return x;
+    }
+
+private:
+    uint64_t key, counter = 0;
+    array<uint32_t, 4> block = {};
+    uint64_t index = 0;
+};
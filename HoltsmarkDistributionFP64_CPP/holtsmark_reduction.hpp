@@ -0,0 +1,142 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cassert>
+#include <algorithm>
+#include "holtsmark_parallel.hpp"
+
+using namespace std;
+
+// elements per reduction block, the summation tree is fixed by element index:
+// pairwise inside each block, then over the block sums of each task, then over the task sums.
+// so results are bit-identical for any thread count and schedule.
+const size_t reduction_block = 1024;
+// blocks per parallel task
+const size_t reduction_task_blocks = 64;
+
+double pairwise_sum(span<const double> v) {
+    if (v.size() <= 16) {
+        double s = 0;
+        for (double x : v) {
+            s += x;
+        }
+        return s;
+    }
+
+    size_t h = v.size() / 2;
+
+    return pairwise_sum(v.first(h)) + pairwise_sum(v.subspan(h));
+}
+
+// number of reduction tasks for n terms, the task sum storage of reproducible_sum
+size_t reproducible_sum_tasks(size_t n) {
+    size_t blocks = (n + reduction_block - 1) / reduction_block;
+
+    return (blocks + reduction_task_blocks - 1) / reduction_task_blocks;
+}
+
+// sum of n terms, fill(i0, buffer) writes the terms [i0, i0 + buffer.size()) into buffer.
+// buffer never exceeds reduction_block and always starts at a multiple of it.
+// task_sums: at least reproducible_sum_tasks(n) elements, run(tasks, func) is a parallel loop.
+template <class Fill, class Run>
+double reproducible_sum_run(size_t n, Fill& fill, span<double> task_sums, Run run) {
+    size_t blocks = (n + reduction_block - 1) / reduction_block;
+    size_t tasks = reproducible_sum_tasks(n);
+
+    assert(task_sums.size() >= tasks);
+
+    run(tasks, [&](size_t task) {
+        size_t b0 = task * reduction_task_blocks, b1 = min(blocks, b0 + reduction_task_blocks);
+
+        double buffer[reduction_block], block_sums[reduction_task_blocks];
+
+        for (size_t b = b0; b < b1; b++) {
+            size_t i0 = b * reduction_block, bn = min(n - i0, reduction_block);
+
+            span<double> terms(buffer, bn);
+            fill(i0, terms);
+
+            block_sums[b - b0] = pairwise_sum(terms);
+        }
+
+        task_sums[task] = pairwise_sum(span<const double>(block_sums, b1 - b0));
+    });
+
+    return pairwise_sum(task_sums.first(tasks));
+}
+
+template <class Fill>
+double reproducible_sum(size_t n, Fill fill, size_t threads = 0) {
+    vector<double> task_sums(reproducible_sum_tasks(n));
+
+    return reproducible_sum_run(n, fill, span<double>(task_sums), [&](size_t tasks, auto func) {
+        parallel_for(tasks, func, threads);
+    });
+}
+
+// caller storage and persistent workers, allocates nothing
+template <class Fill>
+double reproducible_sum(size_t n, Fill fill, span<double> task_sums, parallel_pool& pool) {
+    return reproducible_sum_run(n, fill, task_sums, [&](size_t tasks, auto func) {
+        parallel_for(tasks, func, pool);
+    });
+}
+
+double reproducible_sum(span<const double> values, size_t threads = 0) {
+    return reproducible_sum(values.size(), [&](size_t i0, span<double> buffer) {
+        copy_n(values.begin() + i0, buffer.size(), buffer.begin());
+    }, threads);
+}
+
+// elementwise sum of vector valued terms (e.g. gradients), term(i, acc) adds term i into acc.
+// every component follows the same fixed tree as reproducible_sum.
+template <class Term>
+vector<double> reproducible_sum_vector(size_t n, size_t dim, Term term, size_t threads = 0) {
+    size_t blocks = (n + reduction_block - 1) / reduction_block;
+    size_t tasks = (blocks + reduction_task_blocks - 1) / reduction_task_blocks;
+
+    // task_sums[k * tasks + task]
+    vector<double> task_sums(dim * tasks, 0);
+
+    parallel_for(tasks, [&](size_t task) {
+        size_t b0 = task * reduction_task_blocks, b1 = min(blocks, b0 + reduction_task_blocks);
+
+        // block_sums[k * reduction_task_blocks + b - b0]
+        vector<double> terms(dim * reduction_block), acc(dim), block_sums(dim * reduction_task_blocks);
+
+        for (size_t b = b0; b < b1; b++) {
+            size_t i0 = b * reduction_block, bn = min(n - i0, reduction_block);
+
+            for (size_t i = 0; i < bn; i++) {
+                fill(acc.begin(), acc.end(), 0.0);
+                term(i0 + i, span<double>(acc));
+
+                for (size_t k = 0; k < dim; k++) {
+                    terms[k * reduction_block + i] = acc[k];
+                }
+            }
+
+            for (size_t k = 0; k < dim; k++) {
+                block_sums[k * reduction_task_blocks + b - b0] = pairwise_sum(span<const double>(terms.data() + k * reduction_block, bn));
+            }
+        }
+
+        for (size_t k = 0; k < dim; k++) {
+            task_sums[k * tasks + task] = pairwise_sum(span<const double>(block_sums.data() + k * reduction_task_blocks, b1 - b0));
+        }
+    }, threads);
+
+    vector<double> sums(dim);
+
+    for (size_t k = 0; k < dim; k++) {
+        sums[k] = pairwise_sum(span<const double>(task_sums.data() + k * tasks, tasks));
+    }
+
+    return sums;
+}
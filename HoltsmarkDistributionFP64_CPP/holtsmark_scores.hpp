@@ -0,0 +1,195 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// fused probability integral transforms between holtsmark and standard normal scores.
+// both distributions are symmetric, so z = sign(v) Qn^-1(Qh(|v|)) with the upper tail
+// probabilities Qh, Qn, never forming 1 - p. near the center the half mass
+// delta = P(0 < X < |v|) is used instead of the tail, and below ~1e-300 the log of the tail.
+
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <cassert>
+#include <limits>
+#include <numbers>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_quadrature.hpp"
+
+using namespace std;
+using namespace std::numbers;
+
+// P(X > x) ~ holtsmark_ccdf_limit x^-3/2 with holtsmark_ccdf_limit = 1 / (2 sqrt(2 pi)),
+// and x(q) ~ holtsmark_quantile_limit q^-2/3
+const double holtsmark_ccdf_limit = 1.99471140200716338970e-1;
+const double holtsmark_quantile_limit = 3.41392031627647840734e-1;
+
+// tails below this are carried as logarithms
+const double scores_log_threshold = 1e-300;
+
+// P(0 < X < a), a <= 1/2, 12 point gauss-legendre of the pdf
+double holtsmark_central_mass(double a) {
+    static const quadrature_rule rule = gauss_legendre(12);
+
+    double s = 0;
+    for (size_t i = 0; i < rule.nodes.size(); i++) {
+        s += rule.weights[i] * holtsmark_pdf(a * 0.5 * (rule.nodes[i] + 1));
+    }
+
+    return s * a * 0.5;
+}
+
+// log P(X > a), a > 0
+double holtsmark_log_ccdf(double a) {
+    if (a <= 0x1p+128) {
+        return log(holtsmark_cdf(a, true));
+    }
+
+    return log(holtsmark_ccdf_limit) - 1.5 * log(a);
+}
+
+// acklam's rational approximations of the normal quantile, rel. error 1.15e-9
+double normal_quantile_center_initial(double delta) {
+    const double a[] = {
+        -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+        1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00
+    };
+    const double b[] = {
+        -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+        6.680131188771972e+01, -1.328068155288572e+01
+    };
+
+    double r = delta * delta;
+
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * delta
+        / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+double normal_quantile_tail_initial(double q) {
+    const double c[] = {
+        -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+        -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00
+    };
+    const double d[] = {
+        7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00
+    };
+
+    double t = sqrt(-2 * log(q));
+
+    return -(((((c[0] * t + c[1]) * t + c[2]) * t + c[3]) * t + c[4]) * t + c[5])
+        / ((((d[0] * t + d[1]) * t + d[2]) * t + d[3]) * t + 1);
+}
+
+double normal_pdf(double z) {
+    return exp(-z * z / 2) * (inv_sqrtpi / sqrt2);
+}
+
+// z >= 0 with P(0 < Z < z) = delta, delta < 1/2, one halley step on erf
+double normal_quantile_center(double delta) {
+    double z = normal_quantile_center_initial(delta);
+
+    double u = (erf(z / sqrt2) / 2 - delta) / normal_pdf(z);
+    z -= u / (1 + z * u / 2);
+
+    return z;
+}
+
+// log P(Z > z) for z >= 37 by the asymptotic series of erfc
+double normal_log_ccdf_asymptotic(double z) {
+    double s = 1 / (z * z);
+    double series = s * (-1 + s * (3 + s * (-15 + s * (105 + s * (-945 + s * (10395 + s * -135135))))));
+
+    return -z * z / 2 - log(z) - log(2 * pi) / 2 + log1p(series);
+}
+
+// z with P(Z > z) = exp(log_q), log_q < log(scores_log_threshold)
+double normal_quantile_upper_log(double log_q) {
+    if (log_q == -numeric_limits<double>::infinity()) {
+        return numeric_limits<double>::infinity();
+    }
+
+    double y = -2 * log_q;
+    double z = sqrt(y - log(y) - log(2 * pi));
+
+    for (int iter = 0; iter < 4; iter++) {
+        double log_ccdf = normal_log_ccdf_asymptotic(z);
+        double log_pdf = -z * z / 2 - log(2 * pi) / 2;
+
+        z += (log_ccdf - log_q) / exp(log_pdf - log_ccdf);
+    }
+
+    return z;
+}
+
+// z with P(Z > z) = q, 0 < q <= 1/2, one halley step on erfc
+double normal_quantile_upper(double q) {
+    const double q_low = 0.02425;
+
+    double z = (q > q_low) ? normal_quantile_center_initial(0.5 - q) : normal_quantile_tail_initial(q);
+
+    double u = (erfc(z / sqrt2) / 2 - q) / normal_pdf(z);
+    z += u / (1 - z * u / 2);
+
+    return z;
+}
+
+// x >= 0 with P(0 < X < x) = delta, delta small, newton on the central mass
+double holtsmark_quantile_center(double delta) {
+    double x = delta / holtsmark_pdf(0);
+
+    for (int iter = 0; iter < 3; iter++) {
+        x -= (holtsmark_central_mass(x) - delta) / holtsmark_pdf(x);
+    }
+
+    return x;
+}
+
+// z[i] = Phi^-1(F((x[i] - mu) / c))
+void holtsmark_to_normal_scores(span<const double> x, span<double> z, double mu = 0, double c = 1) {
+    assert(x.size() == z.size());
+
+    double c_inv = 1 / c;
+
+    for (size_t i = 0; i < x.size(); i++) {
+        double v = (x[i] - mu) * c_inv, a = abs(v), s;
+
+        if (isinf(v)) {
+            s = numeric_limits<double>::infinity();
+        }
+        else if (a < 0.5) {
+            s = normal_quantile_center(holtsmark_central_mass(a));
+        }
+        else {
+            double q = (a <= 0x1p+128) ? holtsmark_cdf(a, true) : 0;
+
+            s = (q >= scores_log_threshold)
+                ? normal_quantile_upper(q)
+                : normal_quantile_upper_log(holtsmark_log_ccdf(a));
+        }
+
+        z[i] = copysign(s, v);
+    }
+}
+
+// x[i] = mu + c F^-1(Phi(z[i]))
+void normal_scores_to_holtsmark(span<const double> z, span<double> x, double mu = 0, double c = 1) {
+    assert(z.size() == x.size());
+
+    for (size_t i = 0; i < z.size(); i++) {
+        double b = abs(z[i]), v;
+
+        if (b < 0.16) {
+            v = holtsmark_quantile_center(erf(b / sqrt2) / 2);
+        }
+        else if (b < 37) {
+            v = holtsmark_quantile(erfc(b / sqrt2) / 2, true);
+        }
+        else {
+            v = holtsmark_quantile_limit * exp(-normal_log_ccdf_asymptotic(b) * (2.0 / 3.0));
+        }
+
+        x[i] = mu + c * copysign(v, z[i]);
+    }
+}
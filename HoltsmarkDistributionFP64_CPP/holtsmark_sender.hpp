@@ -0,0 +1,410 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// sender/receiver interface of the batch kernels, after the std::execution model (P2300),
+// which is not part of C++20. a sender describes work, connect(receiver) yields an operation
+// state and start() launches it on the scheduler's execution context without blocking the caller.
+//
+//   receiver:  set_value(value_type), set_error(exception_ptr), set_stopped(),
+//              optionally get_stop_token() returning std::stop_token.
+//   scheduler: schedule() returning a sender of value_type void_value.
+//
+// batch senders check the stop token between blocks and complete with set_stopped when requested.
+
+#pragma once
+
+#include <span>
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <stop_token>
+#include <type_traits>
+#include <condition_variable>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_parallel.hpp"
+
+using namespace std;
+
+namespace holtsmark::exec {
+    // value of the schedule sender
+    struct void_value {};
+
+    template <class Receiver>
+    stop_token get_stop_token(const Receiver& receiver) {
+        if constexpr (requires { { receiver.get_stop_token() } -> convertible_to<stop_token>; }) {
+            return receiver.get_stop_token();
+        }
+        else {
+            return stop_token();
+        }
+    }
+
+    // completes inline on the thread calling start
+    class inline_scheduler {
+    public:
+        struct sender {
+            using value_type = void_value;
+
+            template <class Receiver>
+            struct operation {
+                Receiver receiver;
+
+                void start() noexcept {
+                    receiver.set_value(void_value{});
+                }
+            };
+
+            template <class Receiver>
+            operation<Receiver> connect(Receiver receiver) const {
+                return { move(receiver) };
+            }
+        };
+
+        sender schedule() const {
+            return {};
+        }
+    };
+
+    // fixed set of worker threads running started operations in fifo order
+    class thread_pool {
+    public:
+        class scheduler;
+
+        explicit thread_pool(size_t threads = 0) {
+            threads = parallel_threads(threads);
+
+            for (size_t t = 0; t < threads; t++) {
+                workers.emplace_back([this]() { work(); });
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool() {
+            {
+                lock_guard<mutex> lock(queue_mutex);
+                stopping = true;
+            }
+            queue_ready.notify_all();
+
+            for (thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        class scheduler {
+        public:
+            struct sender {
+                using value_type = void_value;
+
+                thread_pool* pool;
+
+                template <class Receiver>
+                struct operation {
+                    thread_pool* pool;
+                    Receiver receiver;
+
+                    void start() noexcept {
+                        pool->enqueue([this]() { receiver.set_value(void_value{}); });
+                    }
+                };
+
+                template <class Receiver>
+                operation<Receiver> connect(Receiver receiver) const {
+                    return { pool, move(receiver) };
+                }
+            };
+
+            explicit scheduler(thread_pool* pool) : pool(pool) {}
+
+            sender schedule() const {
+                return { pool };
+            }
+
+        private:
+            thread_pool* pool;
+        };
+
+        scheduler get_scheduler() {
+            return scheduler(this);
+        }
+
+    private:
+        vector<thread> workers;
+        deque<function<void()>> queue;
+        mutex queue_mutex;
+        condition_variable queue_ready;
+        bool stopping = false;
+
+        void enqueue(function<void()> task) {
+            {
+                lock_guard<mutex> lock(queue_mutex);
+                queue.push_back(move(task));
+            }
+            queue_ready.notify_one();
+        }
+
+        // drains the queue before exiting
+        void work() {
+            for (;;) {
+                function<void()> task;
+                {
+                    unique_lock<mutex> lock(queue_mutex);
+                    queue_ready.wait(lock, [&]() { return stopping || !queue.empty(); });
+
+                    if (queue.empty()) {
+                        return;
+                    }
+
+                    task = move(queue.front());
+                    queue.pop_front();
+                }
+
+                task();
+            }
+        }
+    };
+
+    // runs kernel(x_block, y_block) blockwise on the scheduler, completes with y
+    template <class Scheduler, class Kernel>
+    class batch_sender {
+    public:
+        using value_type = span<double>;
+
+        batch_sender(Scheduler scheduler, span<const double> x, span<double> y, Kernel kernel)
+            : scheduler(scheduler), x(x), y(y), kernel(kernel) {}
+
+        template <class Receiver>
+        class operation {
+        public:
+            operation(const batch_sender& sender, Receiver receiver)
+                : x(sender.x), y(sender.y), kernel(sender.kernel), receiver(move(receiver)),
+                inner(sender.scheduler.schedule().connect(inner_receiver{ this })) {}
+
+            operation(const operation&) = delete;
+            operation& operator=(const operation&) = delete;
+
+            void start() noexcept {
+                inner.start();
+            }
+
+        private:
+            struct inner_receiver {
+                operation* op;
+
+                void set_value(void_value) noexcept {
+                    op->run();
+                }
+
+                void set_error(exception_ptr e) noexcept {
+                    op->receiver.set_error(e);
+                }
+
+                void set_stopped() noexcept {
+                    op->receiver.set_stopped();
+                }
+            };
+
+            using inner_operation = decltype(declval<Scheduler>().schedule().connect(declval<inner_receiver>()));
+
+            span<const double> x;
+            span<double> y;
+            Kernel kernel;
+            Receiver receiver;
+            inner_operation inner;
+
+            void run() noexcept {
+                stop_token token = get_stop_token(receiver);
+
+                try {
+                    for (size_t i0 = 0; i0 < x.size(); i0 += holtsmark_batch_block) {
+                        if (token.stop_requested()) {
+                            receiver.set_stopped();
+                            return;
+                        }
+
+                        size_t n = min(x.size() - i0, holtsmark_batch_block);
+                        kernel(x.subspan(i0, n), y.subspan(i0, n));
+                    }
+                }
+                catch (...) {
+                    receiver.set_error(current_exception());
+                    return;
+                }
+
+                receiver.set_value(y);
+            }
+        };
+
+        template <class Receiver>
+        operation<Receiver> connect(Receiver receiver) const {
+            return operation<Receiver>(*this, move(receiver));
+        }
+
+    private:
+        Scheduler scheduler;
+        span<const double> x;
+        span<double> y;
+        Kernel kernel;
+    };
+
+    template <class Scheduler>
+    auto pdf(Scheduler scheduler, span<const double> x, span<double> y, double mu = 0, double c = 1) {
+        auto kernel = [=](span<const double> xb, span<double> yb) { holtsmark_pdf_batch(xb, yb, mu, c); };
+        return batch_sender<Scheduler, decltype(kernel)>(scheduler, x, y, kernel);
+    }
+
+    template <class Scheduler>
+    auto cdf(Scheduler scheduler, span<const double> x, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+        auto kernel = [=](span<const double> xb, span<double> yb) { holtsmark_cdf_batch(xb, yb, mu, c, complementary); };
+        return batch_sender<Scheduler, decltype(kernel)>(scheduler, x, y, kernel);
+    }
+
+    template <class Scheduler>
+    auto quantile(Scheduler scheduler, span<const double> p, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+        auto kernel = [=](span<const double> pb, span<double> yb) { holtsmark_quantile_batch(pb, yb, mu, c, complementary); };
+        return batch_sender<Scheduler, decltype(kernel)>(scheduler, p, y, kernel);
+    }
+
+    // engine must outlive the operation and is not shared with concurrent operations
+    template <class Scheduler, class Engine>
+    auto sample(Scheduler scheduler, Engine& engine, span<double> y, double mu = 0, double c = 1) {
+        auto kernel = [=, &engine](span<const double>, span<double> yb) { holtsmark_sample_batch(engine, yb, mu, c); };
+        return batch_sender<Scheduler, decltype(kernel)>(scheduler, span<const double>(y.data(), y.size()), y, kernel);
+    }
+
+    // completes with func(value) on the context of the predecessor
+    template <class Sender, class Func>
+    class then_sender {
+    public:
+        using value_type = invoke_result_t<Func, typename Sender::value_type>;
+
+        then_sender(Sender sender, Func func) : sender(move(sender)), func(move(func)) {}
+
+        template <class Receiver>
+        class operation {
+        public:
+            operation(const then_sender& s, Receiver receiver)
+                : func(s.func), receiver(move(receiver)), inner(s.sender.connect(inner_receiver{ this })) {}
+
+            operation(const operation&) = delete;
+            operation& operator=(const operation&) = delete;
+
+            void start() noexcept {
+                inner.start();
+            }
+
+        private:
+            struct inner_receiver {
+                operation* op;
+
+                void set_value(typename Sender::value_type value) noexcept {
+                    try {
+                        op->receiver.set_value(op->func(move(value)));
+                    }
+                    catch (...) {
+                        op->receiver.set_error(current_exception());
+                    }
+                }
+
+                void set_error(exception_ptr e) noexcept {
+                    op->receiver.set_error(e);
+                }
+
+                void set_stopped() noexcept {
+                    op->receiver.set_stopped();
+                }
+
+                stop_token get_stop_token() const {
+                    return exec::get_stop_token(op->receiver);
+                }
+            };
+
+            using inner_operation = decltype(declval<const Sender&>().connect(declval<inner_receiver>()));
+
+            Func func;
+            Receiver receiver;
+            inner_operation inner;
+        };
+
+        template <class Receiver>
+        operation<Receiver> connect(Receiver receiver) const {
+            return operation<Receiver>(*this, move(receiver));
+        }
+
+    private:
+        Sender sender;
+        Func func;
+    };
+
+    template <class Sender, class Func>
+    then_sender<Sender, Func> then(Sender sender, Func func) {
+        return then_sender<Sender, Func>(move(sender), move(func));
+    }
+
+    // blocks the calling thread until the sender completes, for tests and for bridging to blocking code.
+    // empty if stopped, rethrows errors. source may be used to request a stop.
+    template <class Sender>
+    optional<typename Sender::value_type> sync_wait(const Sender& sender, stop_source* source = nullptr) {
+        using value_type = typename Sender::value_type;
+
+        struct state {
+            mutex m;
+            condition_variable cv;
+            bool done = false;
+            optional<value_type> value;
+            exception_ptr error;
+            stop_token token;
+        } st;
+
+        st.token = source != nullptr ? source->get_token() : stop_token();
+
+        struct receiver {
+            state* st;
+
+            void complete() noexcept {
+                lock_guard<mutex> lock(st->m);
+                st->done = true;
+                st->cv.notify_one();
+            }
+
+            void set_value(value_type value) noexcept {
+                st->value.emplace(move(value));
+                complete();
+            }
+
+            void set_error(exception_ptr e) noexcept {
+                st->error = e;
+                complete();
+            }
+
+            void set_stopped() noexcept {
+                complete();
+            }
+
+            stop_token get_stop_token() const {
+                return st->token;
+            }
+        };
+
+        auto op = sender.connect(receiver{ &st });
+        op.start();
+
+        unique_lock<mutex> lock(st.m);
+        st.cv.wait(lock, [&]() { return st.done; });
+
+        if (st.error) {
+            rethrow_exception(st.error);
+        }
+
+        return move(st.value);
+    }
+}
@@ -0,0 +1,496 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// shadow-precision accuracy telemetry. a random 1-in-N subsample of pdf / cdf calls is
+// re-evaluated on a background thread with the same segment approximations in double-double,
+// so the statistics measure the rounding error of the double evaluation per segment
+// (the approximation error of the rational functions themselves is fixed and not included).
+// the hot path pays a thread-local countdown (one per thread and instance) and, when sampled,
+// one lock-free enqueue; samples are dropped when the queue is full.
+
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <array>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <stop_token>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_batch.hpp"
+
+using namespace std;
+
+// unevaluated sum hi + lo, |lo| <= ulp(hi) / 2
+struct double_double {
+    double hi, lo;
+};
+
+double_double dd_fast_two_sum(double a, double b) {
+    double s = a + b;
+
+    return { s, b - (s - a) };
+}
+
+double_double dd_add(double_double a, double_double b) {
+    double s = a.hi + b.hi, bb = s - a.hi;
+    double e = (a.hi - (s - bb)) + (b.hi - bb);
+
+    return dd_fast_two_sum(s, e + a.lo + b.lo);
+}
+
+double_double dd_mul(double_double a, double_double b) {
+    double p = a.hi * b.hi;
+    double e = fma(a.hi, b.hi, -p) + (a.hi * b.lo + a.lo * b.hi);
+
+    return dd_fast_two_sum(p, e);
+}
+
+double_double dd_div(double_double a, double_double b) {
+    double q1 = a.hi / b.hi;
+
+    double_double r = dd_add(a, dd_mul(b, { -q1, 0 }));
+    double q2 = r.hi / b.hi;
+
+    return dd_fast_two_sum(q1, q2);
+}
+
+double_double dd_sqrt(double_double a) {
+    double s = sqrt(a.hi);
+
+    double_double r = dd_add(a, dd_mul({ -s, 0 }, { s, 0 }));
+
+    return dd_fast_two_sum(s, r.hi / (2 * s));
+}
+
+double_double dd_pade(double_double x, const vector<double>& numer, const vector<double>& denom) {
+    double_double sc = { numer.back(), 0 }, sd = { denom.back(), 0 };
+
+    for (int i = (int)numer.size() - 2; i >= 0; i--) {
+        sc = dd_add(dd_mul(sc, x), { numer[i], 0 });
+    }
+    for (int i = (int)denom.size() - 2; i >= 0; i--) {
+        sd = dd_add(dd_mul(sd, x), { denom[i], 0 });
+    }
+
+    return dd_div(sc, sd);
+}
+
+// double-double counterparts of holtsmark_pdf and holtsmark_cdf, finite x
+double_double holtsmark_pdf_shadow(double x) {
+    const vector<pade_segment>& segments = holtsmark_pdf_segments();
+
+    x = abs(x);
+
+    int index = holtsmark_pdf_segment_index(x);
+    const pade_segment& segment = segments[index];
+
+    if (index < holtsmark_pdf_limit_index) {
+        return dd_pade(dd_add({ x, 0 }, { -segment.offset, 0 }), segment.numer, segment.denom);
+    }
+
+    double_double r = dd_div({ 1, 0 }, { x, 0 });
+    double_double u = dd_mul(r, dd_sqrt(r));
+
+    return dd_mul(dd_pade(u, segment.numer, segment.denom), dd_mul(u, r));
+}
+
+double_double holtsmark_cdf_shadow(double x, bool complementary = false) {
+    const vector<pade_segment>& segments = holtsmark_cdf_segments();
+
+    bool inversion = (x <= 0) ^ complementary;
+
+    x = abs(x);
+
+    int index = holtsmark_cdf_segment_index(x);
+    const pade_segment& segment = segments[index];
+
+    double_double y;
+    if (index < holtsmark_cdf_limit_index) {
+        y = dd_pade(dd_add({ x, 0 }, { -segment.offset, 0 }), segment.numer, segment.denom);
+    }
+    else {
+        double_double r = dd_div({ 1, 0 }, { x, 0 });
+        double_double u = dd_mul(r, dd_sqrt(r));
+
+        y = dd_mul(dd_pade(u, segment.numer, segment.denom), u);
+    }
+
+    return inversion ? y : dd_add({ 1, 0 }, { -y.hi, -y.lo });
+}
+
+// multiple producer ring (vyukov's bounded queue), capacity rounded up to a power of 2
+template <class T>
+class mpsc_queue {
+public:
+    explicit mpsc_queue(size_t capacity)
+        : mask(bit_ceil(max(capacity, (size_t)2)) - 1), cells(make_unique<cell[]>(mask + 1)) {
+
+        for (size_t i = 0; i <= mask; i++) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    // any thread, false if full
+    bool push(const T& value) {
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+
+        for (;;) {
+            cell& c = cells[pos & mask];
+            intptr_t diff = (intptr_t)c.sequence.load(memory_order_acquire) - (intptr_t)pos;
+
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    c.value = value;
+                    c.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    // single consumer, false if empty
+    bool pop(T& value) {
+        cell& c = cells[dequeue_pos & mask];
+
+        if ((intptr_t)c.sequence.load(memory_order_acquire) - (intptr_t)(dequeue_pos + 1) < 0) {
+            return false;
+        }
+
+        value = c.value;
+        c.sequence.store(dequeue_pos + mask + 1, memory_order_release);
+        dequeue_pos++;
+
+        return true;
+    }
+
+private:
+    struct cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+
+    size_t mask;
+    unique_ptr<cell[]> cells;
+
+    alignas(64) atomic<size_t> enqueue_pos = 0;
+    alignas(64) size_t dequeue_pos = 0;
+};
+
+// per-thread sampling state slots, one per live telemetry instance
+const size_t holtsmark_shadow_slots = 64;
+
+enum class holtsmark_shadow_kind {
+    pdf, cdf, ccdf
+};
+
+// standardized argument of a sampled call, the batch kernels are bit-identical
+// to the scalar functions on it, so the double result is recomputed in the background
+struct holtsmark_shadow_sample {
+    holtsmark_shadow_kind kind = holtsmark_shadow_kind::pdf;
+    double x = 0;
+};
+
+struct holtsmark_shadow_record {
+    holtsmark_shadow_kind kind = holtsmark_shadow_kind::pdf;
+    double x = 0, y = 0, reference = 0, relative_error = 0;
+};
+
+struct holtsmark_shadow_segment_stats {
+    uint64_t count = 0;
+    double sum_relative_error = 0, max_relative_error = 0;
+
+    double mean_relative_error() const {
+        return count > 0 ? sum_relative_error / (double)count : 0;
+    }
+};
+
+struct holtsmark_shadow_report {
+    uint64_t sampled = 0, dropped = 0;
+
+    // indexed by holtsmark_pdf_segment_index / holtsmark_cdf_segment_index, cdf includes ccdf
+    vector<holtsmark_shadow_segment_stats> pdf_segments, cdf_segments;
+
+    // largest relative errors, descending
+    vector<holtsmark_shadow_record> worst;
+};
+
+class holtsmark_shadow_telemetry {
+public:
+    // samples on average one call in period, keeps the worst_count largest errors
+    explicit holtsmark_shadow_telemetry(uint64_t period = 4096, size_t worst_count = 32, size_t queue_capacity = 4096)
+        : period(max(period, (uint64_t)1)), worst_count(worst_count), queue(queue_capacity),
+        pdf_segments(holtsmark_pdf_limit_index + 1), cdf_segments(holtsmark_cdf_limit_index + 1),
+        id(next_id().fetch_add(1) + 1), slot(acquire_slot(id)),
+        worker([this](stop_token token) { work(token); }) {}
+
+    ~holtsmark_shadow_telemetry() {
+        release_slot(slot);
+    }
+
+    holtsmark_shadow_telemetry(const holtsmark_shadow_telemetry&) = delete;
+    holtsmark_shadow_telemetry& operator=(const holtsmark_shadow_telemetry&) = delete;
+
+    double pdf(double x) {
+        double y = holtsmark_pdf(x);
+
+        thread_state& st = state();
+
+        if (--st.countdown == 0) [[unlikely]] {
+            sample(st, { holtsmark_shadow_kind::pdf, x });
+        }
+
+        return y;
+    }
+
+    double cdf(double x, bool complementary = false) {
+        double y = holtsmark_cdf(x, complementary);
+
+        thread_state& st = state();
+
+        if (--st.countdown == 0) [[unlikely]] {
+            sample(st, { complementary ? holtsmark_shadow_kind::ccdf : holtsmark_shadow_kind::cdf, x });
+        }
+
+        return y;
+    }
+
+    void pdf_batch(span<const double> x, span<double> y, double mu = 0, double c = 1) {
+        holtsmark_pdf_batch(x, y, mu, c);
+        sample_batch(holtsmark_shadow_kind::pdf, x, mu, c);
+    }
+
+    void cdf_batch(span<const double> x, span<double> y, double mu = 0, double c = 1, bool complementary = false) {
+        holtsmark_cdf_batch(x, y, mu, c, complementary);
+        sample_batch(complementary ? holtsmark_shadow_kind::ccdf : holtsmark_shadow_kind::cdf, x, mu, c);
+    }
+
+    // snapshot of the statistics evaluated so far
+    holtsmark_shadow_report report() const {
+        lock_guard<mutex> lock(stats_mutex);
+
+        return { sampled.load(), dropped.load(), pdf_segments, cdf_segments, worst };
+    }
+
+    // csv of the worst inputs: kind,x,y,reference,relative_error
+    void write_worst(ostream& stream) const {
+        static const char* kind_names[] = { "pdf", "cdf", "ccdf" };
+
+        holtsmark_shadow_report r = report();
+
+        stream.precision(17);
+        stream << "kind,x,y,reference,relative_error\n";
+
+        for (const holtsmark_shadow_record& record : r.worst) {
+            stream << kind_names[(int)record.kind] << ',' << record.x << ',' << record.y << ','
+                << record.reference << ',' << record.relative_error << '\n';
+        }
+    }
+
+private:
+    uint64_t period;
+    size_t worst_count;
+    mpsc_queue<holtsmark_shadow_sample> queue;
+
+    mutable mutex stats_mutex;
+    vector<holtsmark_shadow_segment_stats> pdf_segments, cdf_segments;
+    vector<holtsmark_shadow_record> worst;
+
+    atomic<uint64_t> sampled = 0, dropped = 0;
+
+    uint64_t id;
+    size_t slot;
+
+    jthread worker;
+
+    // sampling state of one thread for the instance owning the slot,
+    // reset when the thread first meets a new owner
+    struct thread_state {
+        uint64_t owner = 0, countdown = 0, rng = 0;
+    };
+
+    static atomic<uint64_t>& next_id() {
+        static atomic<uint64_t> id = 0;
+        return id;
+    }
+
+    static mutex& slots_mutex() {
+        static mutex m;
+        return m;
+    }
+
+    static array<bool, holtsmark_shadow_slots>& slots_used() {
+        static array<bool, holtsmark_shadow_slots> used = {};
+        return used;
+    }
+
+    // a free slot, or a shared one beyond holtsmark_shadow_slots live instances
+    // (still attributed correctly, but the instances sharing it reset each other's countdown)
+    static size_t acquire_slot(uint64_t id) {
+        lock_guard<mutex> lock(slots_mutex());
+
+        array<bool, holtsmark_shadow_slots>& used = slots_used();
+
+        for (size_t k = 0; k < holtsmark_shadow_slots; k++) {
+            if (!used[k]) {
+                used[k] = true;
+                return k;
+            }
+        }
+
+        return (size_t)(id % holtsmark_shadow_slots);
+    }
+
+    static void release_slot(size_t k) {
+        lock_guard<mutex> lock(slots_mutex());
+
+        slots_used()[k] = false;
+    }
+
+    thread_state& state() {
+        thread_local array<thread_state, holtsmark_shadow_slots> states;
+
+        thread_state& st = states[slot];
+
+        if (st.owner != id) [[unlikely]] {
+            st.owner = id;
+            st.rng = (hash<thread::id>()(this_thread::get_id()) ^ (id * 0x9E3779B97F4A7C15ull)) | 1u;
+            st.countdown = next_gap(st);
+        }
+
+        return st;
+    }
+
+    // next gap uniform in [1, 2 period - 1], so periodic call patterns do not alias
+    uint64_t next_gap(thread_state& st) {
+        st.rng ^= st.rng << 13;
+        st.rng ^= st.rng >> 7;
+        st.rng ^= st.rng << 17;
+
+        return 1 + st.rng % (2 * period - 1);
+    }
+
+    void sample(thread_state& st, const holtsmark_shadow_sample& s) {
+        st.countdown = next_gap(st);
+
+        if (queue.push(s)) {
+            sampled.fetch_add(1, memory_order_relaxed);
+        }
+        else {
+            dropped.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    // the countdown advances by the batch length, every element it reaches is sampled
+    void sample_batch(holtsmark_shadow_kind kind, span<const double> x, double mu, double c) {
+        thread_state& st = state();
+
+        if (st.countdown > x.size()) [[likely]] {
+            st.countdown -= x.size();
+            return;
+        }
+
+        double c_inv = 1 / c;
+
+        size_t i = 0;
+        while (st.countdown <= x.size() - i) {
+            i += st.countdown;
+            sample(st, { kind, (x[i - 1] - mu) * c_inv });
+        }
+
+        st.countdown -= x.size() - i;
+    }
+
+    void work(stop_token token) {
+        holtsmark_shadow_sample s;
+
+        while (!token.stop_requested()) {
+            if (!queue.pop(s)) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+                continue;
+            }
+
+            do {
+                evaluate(s);
+            } while (queue.pop(s));
+        }
+
+        while (queue.pop(s)) {
+            evaluate(s);
+        }
+    }
+
+    void evaluate(const holtsmark_shadow_sample& s) {
+        if (!isfinite(s.x)) {
+            return;
+        }
+
+        double y;
+        double_double reference;
+        int index;
+
+        if (s.kind == holtsmark_shadow_kind::pdf) {
+            y = holtsmark_pdf(s.x);
+            reference = holtsmark_pdf_shadow(s.x);
+            index = holtsmark_pdf_segment_index(s.x);
+        }
+        else {
+            bool complementary = s.kind == holtsmark_shadow_kind::ccdf;
+
+            y = holtsmark_cdf(s.x, complementary);
+            reference = holtsmark_cdf_shadow(s.x, complementary);
+            index = holtsmark_cdf_segment_index(s.x);
+        }
+
+        double error = (reference.hi != 0)
+            ? abs((y - reference.hi) - reference.lo) / abs(reference.hi)
+            : (y != 0 ? 1.0 : 0.0);
+
+        lock_guard<mutex> lock(stats_mutex);
+
+        holtsmark_shadow_segment_stats& stats =
+            (s.kind == holtsmark_shadow_kind::pdf) ? pdf_segments[index] : cdf_segments[index];
+
+        stats.count++;
+        stats.sum_relative_error += error;
+        stats.max_relative_error = max(stats.max_relative_error, error);
+
+        if (worst_count > 0 && (worst.size() < worst_count || error > worst.back().relative_error)) {
+            holtsmark_shadow_record record = { s.kind, s.x, y, reference.hi + reference.lo, error };
+
+            // repeated inputs are kept once
+            for (const holtsmark_shadow_record& w : worst) {
+                if (w.kind == s.kind && w.x == s.x) {
+                    return;
+                }
+            }
+
+            auto it = upper_bound(worst.begin(), worst.end(), record,
+                [](const holtsmark_shadow_record& a, const holtsmark_shadow_record& b) {
+                    return a.relative_error > b.relative_error;
+                });
+
+            worst.insert(it, record);
+
+            if (worst.size() > worst_count) {
+                worst.pop_back();
+            }
+        }
+    }
+};
@@ -0,0 +1,415 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// shared memory ring evaluator for co-located processes (POSIX only, futex on linux).
+//
+// the segment holds a bounded multi-producer / single-consumer ring of slots.
+// a client claims a slot by CAS on the enqueue position, writes its x-batch into the slot
+// and publishes it through the slot sequence. the worker evaluates the slot in place and
+// sets the slot state to done, the client reads the results and releases the slot.
+// the fast path is atomics and spinning only, a client that waits longer than its spin
+// budget sleeps on the slot state with a futex and the worker wakes it.
+// likewise the worker sleeps on the header after its idle budget and the next client wakes it.
+// operation codes are the same as the socket daemon.
+
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <atomic>
+#include <span>
+#include <string>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#include "holtsmark_batch.hpp"
+#include "holtsmark_daemon.hpp"
+
+using namespace std;
+
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free);
+
+const uint64_t holtsmark_shm_magic = 0x484F4C5453524E47ull;
+
+enum holtsmark_shm_state : uint32_t {
+    holtsmark_shm_pending = 0,
+    holtsmark_shm_done = 1,
+    holtsmark_shm_sleeping = 2,
+};
+
+struct alignas(64) holtsmark_shm_header {
+    uint64_t magic;
+    uint32_t slots, capacity;
+    uint64_t slot_bytes;
+
+    alignas(64) atomic<uint64_t> enqueue_pos;
+    alignas(64) atomic<uint64_t> dequeue_pos;
+    alignas(64) atomic<uint32_t> stopping;
+    alignas(64) atomic<uint32_t> worker_sleeping;
+};
+
+struct alignas(64) holtsmark_shm_slot {
+    atomic<uint64_t> sequence;
+    atomic<uint32_t> state;
+    uint8_t op, complementary;
+    uint16_t status;
+    uint32_t count;
+    double mu, c;
+    uint64_t seed;
+    // followed by capacity doubles, inputs are overwritten with results
+};
+
+size_t holtsmark_shm_slot_bytes(uint32_t capacity) {
+    return (sizeof(holtsmark_shm_slot) + capacity * sizeof(double) + 63) / 64 * 64;
+}
+
+size_t holtsmark_shm_segment_bytes(uint32_t slots, uint32_t capacity) {
+    return sizeof(holtsmark_shm_header) + slots * holtsmark_shm_slot_bytes(capacity);
+}
+
+void holtsmark_shm_futex_wait(atomic<uint32_t>& word, uint32_t expected) {
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAIT, expected, nullptr, nullptr, 0);
+#else
+    if (word.load(memory_order_acquire) == expected) {
+        sched_yield();
+    }
+#endif
+}
+
+void holtsmark_shm_futex_wake(atomic<uint32_t>& word) {
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+void holtsmark_shm_pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// mapping of a named segment, shared by the worker and the clients
+class holtsmark_shm_mapping {
+public:
+    holtsmark_shm_mapping(const holtsmark_shm_mapping&) = delete;
+    holtsmark_shm_mapping& operator=(const holtsmark_shm_mapping&) = delete;
+
+    ~holtsmark_shm_mapping() {
+        if (base != nullptr) {
+            munmap(base, bytes);
+        }
+    }
+
+    holtsmark_shm_header& header() const {
+        return *(holtsmark_shm_header*)base;
+    }
+
+    holtsmark_shm_slot& slot(uint64_t pos) const {
+        uint8_t* p = (uint8_t*)base + sizeof(holtsmark_shm_header) + (pos % header().slots) * header().slot_bytes;
+        return *(holtsmark_shm_slot*)p;
+    }
+
+    double* slot_values(holtsmark_shm_slot& s) const {
+        return (double*)((uint8_t*)&s + sizeof(holtsmark_shm_slot));
+    }
+
+protected:
+    void* base = nullptr;
+    size_t bytes = 0;
+
+    holtsmark_shm_mapping() = default;
+
+    void map(int fd, size_t size) {
+        bytes = size;
+        base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (base == MAP_FAILED) {
+            base = nullptr;
+            throw runtime_error("holtsmark_shm: mmap failed");
+        }
+    }
+};
+
+// owns the segment and runs the single consumer
+class holtsmark_shm_worker : public holtsmark_shm_mapping {
+public:
+    // idle polls before the worker sleeps on a futex
+    uint32_t spin_limit = 1u << 16;
+
+    // slots must be a power of two, capacity is the maximum batch size per request
+    holtsmark_shm_worker(string name, uint32_t slots = 64, uint32_t capacity = 4096) : name(name) {
+        if (slots == 0 || (slots & (slots - 1)) != 0) {
+            throw invalid_argument("holtsmark_shm: slots must be a power of two");
+        }
+
+        size_t size = holtsmark_shm_segment_bytes(slots, capacity);
+
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 || ftruncate(fd, size) < 0) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            throw runtime_error("holtsmark_shm: shm_open failed");
+        }
+
+        map(fd, size);
+
+        holtsmark_shm_header& h = header();
+        h.slots = slots;
+        h.capacity = capacity;
+        h.slot_bytes = holtsmark_shm_slot_bytes(capacity);
+        h.enqueue_pos.store(0, memory_order_relaxed);
+        h.dequeue_pos.store(0, memory_order_relaxed);
+        h.stopping.store(0, memory_order_relaxed);
+        h.worker_sleeping.store(0, memory_order_relaxed);
+
+        for (uint32_t i = 0; i < slots; i++) {
+            slot(i).sequence.store(i, memory_order_relaxed);
+            slot(i).state.store(holtsmark_shm_pending, memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_release);
+        h.magic = holtsmark_shm_magic;
+    }
+
+    ~holtsmark_shm_worker() {
+        shm_unlink(name.c_str());
+    }
+
+    // serves until stop(), cpu >= 0 pins the calling thread (linux)
+    void run(int cpu = -1) {
+#if defined(__linux__)
+        if (cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+#else
+        (void)cpu;
+#endif
+
+        holtsmark_shm_header& h = header();
+        uint32_t idle = 0;
+
+        while (!h.stopping.load(memory_order_relaxed)) {
+            if (poll_once()) {
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < spin_limit) {
+                holtsmark_shm_pause();
+                continue;
+            }
+
+            // announce the sleep before the last look at the ring, a client publishes
+            // before it looks at worker_sleeping, so one of the two sees the other
+            h.worker_sleeping.store(1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+
+            if (!ready() && !h.stopping.load(memory_order_relaxed)) {
+                holtsmark_shm_futex_wait(h.worker_sleeping, 1);
+            }
+
+            h.worker_sleeping.store(0, memory_order_relaxed);
+            idle = 0;
+        }
+    }
+
+    void stop() {
+        holtsmark_shm_header& h = header();
+
+        h.stopping.store(1, memory_order_relaxed);
+        h.worker_sleeping.store(0, memory_order_seq_cst);
+        holtsmark_shm_futex_wake(h.worker_sleeping);
+    }
+
+    // the next slot is published
+    bool ready() const {
+        uint64_t pos = header().dequeue_pos.load(memory_order_relaxed);
+
+        return slot(pos).sequence.load(memory_order_acquire) == pos + 1;
+    }
+
+    // evaluates the next published slot if any
+    bool poll_once() {
+        holtsmark_shm_header& h = header();
+
+        if (!ready()) {
+            return false;
+        }
+
+        uint64_t pos = h.dequeue_pos.load(memory_order_relaxed);
+        holtsmark_shm_slot& s = slot(pos);
+
+        evaluate(s);
+
+        h.dequeue_pos.store(pos + 1, memory_order_relaxed);
+
+        if (s.state.exchange(holtsmark_shm_done, memory_order_acq_rel) == holtsmark_shm_sleeping) {
+            holtsmark_shm_futex_wake(s.state);
+        }
+
+        return true;
+    }
+
+private:
+    string name;
+
+    void evaluate(holtsmark_shm_slot& s) {
+        span<double> values(slot_values(s), min(s.count, header().capacity));
+
+        s.status = holtsmark_daemon_ok;
+
+        if (!(s.c > 0 && isfinite(s.c) && isfinite(s.mu)) || s.count > header().capacity) {
+            s.status = holtsmark_daemon_bad_request;
+            return;
+        }
+
+        switch (s.op) {
+        case holtsmark_daemon_pdf:
+            holtsmark_pdf_batch(values, values, s.mu, s.c);
+            break;
+        case holtsmark_daemon_cdf:
+            holtsmark_cdf_batch(values, values, s.mu, s.c, s.complementary != 0);
+            break;
+        case holtsmark_daemon_quantile:
+            holtsmark_quantile_batch(values, values, s.mu, s.c, s.complementary != 0);
+            break;
+        case holtsmark_daemon_sample: {
+            mt19937_64 engine(s.seed);
+            holtsmark_sample_batch(engine, values, s.mu, s.c);
+            break;
+        }
+        default:
+            s.status = holtsmark_daemon_bad_request;
+        }
+    }
+};
+
+// producer side, any number of clients (threads or processes) may share a segment
+class holtsmark_shm_client : public holtsmark_shm_mapping {
+public:
+    // spins before sleeping on a futex while waiting for the result
+    uint32_t spin_limit = 1u << 14;
+
+    holtsmark_shm_client(string name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            throw runtime_error("holtsmark_shm: segment not found");
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            throw runtime_error("holtsmark_shm: fstat failed");
+        }
+
+        map(fd, st.st_size);
+
+        if (header().magic != holtsmark_shm_magic) {
+            throw runtime_error("holtsmark_shm: segment not initialized");
+        }
+    }
+
+    uint32_t capacity() const {
+        return header().capacity;
+    }
+
+    // evaluates op on x into y (x.size() == y.size() <= capacity), for sample x is empty
+    bool evaluate(holtsmark_daemon_op op, span<const double> x, span<double> y,
+        double mu = 0, double c = 1, bool complementary = false, uint64_t seed = 0) {
+
+        holtsmark_shm_header& h = header();
+
+        if (y.size() > h.capacity || (op != holtsmark_daemon_sample && x.size() != y.size())) {
+            return false;
+        }
+
+        uint64_t pos = h.enqueue_pos.load(memory_order_relaxed);
+        holtsmark_shm_slot* s;
+
+        for (;;) {
+            s = &slot(pos);
+            uint64_t seq = s->sequence.load(memory_order_acquire);
+
+            if (seq == pos) {
+                if (h.enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (seq < pos) {
+                // ring full, wait for a slot to be released
+                holtsmark_shm_pause();
+                pos = h.enqueue_pos.load(memory_order_relaxed);
+            }
+            else {
+                pos = h.enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+
+        s->op = op;
+        s->complementary = complementary ? 1 : 0;
+        s->count = (uint32_t)y.size();
+        s->mu = mu;
+        s->c = c;
+        s->seed = seed;
+        s->state.store(holtsmark_shm_pending, memory_order_relaxed);
+        copy(x.begin(), x.end(), slot_values(*s));
+
+        s->sequence.store(pos + 1, memory_order_release);
+
+        atomic_thread_fence(memory_order_seq_cst);
+        if (h.worker_sleeping.load(memory_order_relaxed) != 0) {
+            h.worker_sleeping.store(0, memory_order_relaxed);
+            holtsmark_shm_futex_wake(h.worker_sleeping);
+        }
+
+        uint32_t spins = 0;
+        while (s->state.load(memory_order_acquire) != holtsmark_shm_done) {
+            if (++spins < spin_limit) {
+                holtsmark_shm_pause();
+                continue;
+            }
+
+            uint32_t expected = holtsmark_shm_pending;
+            if (s->state.compare_exchange_strong(expected, holtsmark_shm_sleeping, memory_order_acq_rel)
+                || expected == holtsmark_shm_sleeping) {
+                holtsmark_shm_futex_wait(s->state, holtsmark_shm_sleeping);
+            }
+        }
+
+        bool ok = s->status == holtsmark_daemon_ok;
+        if (ok) {
+            copy_n(slot_values(*s), y.size(), y.begin());
+        }
+
+        // release the slot for the producer one lap ahead
+        s->sequence.store(pos + h.slots, memory_order_release);
+
+        return ok;
+    }
+};
+
+#endif
@@ -0,0 +1,282 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// background variate pre-generation: producer threads fill cache-aligned blocks with the
+// batch sampler and hand them to consumers through lock-free spsc queues.
+// every consumer owns a fixed set of blocks that circulate between a free and a full queue,
+// so memory is bounded and producers stall (back-pressure) once all blocks of a consumer are full.
+// an idle producer and a starved consumer block on atomic wait, woken by the other side's handoff.
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include "holtsmark_batch.hpp"
+#include "holtsmark_random.hpp"
+
+using namespace std;
+
+// variates per block
+const size_t holtsmark_variate_block_size = 1024;
+
+struct alignas(64) holtsmark_variate_block {
+    double values[holtsmark_variate_block_size];
+};
+
+// handoff counter, bumped and notified by one side, waited on by the other
+struct alignas(64) holtsmark_variate_signal {
+    atomic<uint32_t> value = 0;
+
+    void notify() {
+        value.fetch_add(1, memory_order_release);
+        value.notify_one();
+    }
+};
+
+// single producer, single consumer ring, capacity rounded up to a power of 2
+template <class T>
+class spsc_queue {
+public:
+    explicit spsc_queue(size_t capacity) : items(bit_ceil(max(capacity, (size_t)1))), mask(items.size() - 1) {}
+
+    // producer side, false if full
+    bool push(T value) {
+        size_t t = tail.load(memory_order_relaxed);
+
+        if (t - head_cache >= items.size()) {
+            head_cache = head.load(memory_order_acquire);
+            if (t - head_cache >= items.size()) {
+                return false;
+            }
+        }
+
+        items[t & mask] = value;
+        tail.store(t + 1, memory_order_release);
+
+        return true;
+    }
+
+    // consumer side, false if empty
+    bool pop(T& value) {
+        size_t h = head.load(memory_order_relaxed);
+
+        if (h == tail_cache) {
+            tail_cache = tail.load(memory_order_acquire);
+            if (h == tail_cache) {
+                return false;
+            }
+        }
+
+        value = items[h & mask];
+        head.store(h + 1, memory_order_release);
+
+        return true;
+    }
+
+private:
+    vector<T> items;
+    size_t mask;
+
+    alignas(64) atomic<size_t> head = 0;
+    size_t tail_cache = 0;
+
+    alignas(64) atomic<size_t> tail = 0;
+    size_t head_cache = 0;
+};
+
+class holtsmark_variate_service {
+public:
+    // used by one thread only
+    class consumer {
+    public:
+        consumer(size_t blocks, uint64_t seed, uint64_t stream)
+            : engine(seed, stream << 48), storage(blocks), full(blocks), free(blocks) {
+
+            for (uint32_t b = 0; b < blocks; b++) {
+                free.push(b);
+            }
+        }
+
+        double next() {
+            if (index >= holtsmark_variate_block_size) {
+                advance();
+            }
+
+            return storage[current].values[index++];
+        }
+
+        void fill(span<double> y) {
+            for (size_t i = 0; i < y.size();) {
+                if (index >= holtsmark_variate_block_size) {
+                    advance();
+                }
+
+                size_t n = min(y.size() - i, holtsmark_variate_block_size - index);
+
+                copy_n(storage[current].values + index, n, y.begin() + i);
+
+                index += n;
+                i += n;
+            }
+        }
+
+        // number of times the consumer found no pre-filled block
+        uint64_t stalls() const {
+            return stall_count;
+        }
+
+    private:
+        friend class holtsmark_variate_service;
+
+        // producer state, stream position (stream << 48) + variates drawn, 2 draws per variate
+        philox_engine engine;
+
+        vector<holtsmark_variate_block> storage;
+        spsc_queue<uint32_t> full, free;
+
+        // filled: notified by the producer per full block, producer: the serving producer's signal
+        holtsmark_variate_signal filled;
+        holtsmark_variate_signal* producer = nullptr;
+
+        uint32_t current = 0;
+        size_t index = holtsmark_variate_block_size;
+        bool holding = false;
+        uint64_t stall_count = 0;
+
+        void advance() {
+            if (holding) {
+                free.push(current);
+                producer->notify();
+            }
+
+            if (!full.pop(current)) {
+                stall_count++;
+
+                // the counter is read before the pop, a block pushed after a failed pop changes it
+                for (;;) {
+                    uint32_t seen = filled.value.load(memory_order_acquire);
+                    if (full.pop(current)) {
+                        break;
+                    }
+                    filled.value.wait(seen, memory_order_acquire);
+                }
+            }
+
+            holding = true;
+            index = 0;
+        }
+
+        // producer side, fills one free block if any
+        bool produce(double mu, double c) {
+            uint32_t b;
+            if (!free.pop(b)) {
+                return false;
+            }
+
+            holtsmark_sample_batch(engine, span<double>(storage[b].values), mu, c);
+            full.push(b);
+            filled.notify();
+
+            return true;
+        }
+    };
+
+    // consumer k draws the reproducible sequence of stream (seed, k), independent of producers and timing.
+    // memory is consumers * blocks_per_consumer * holtsmark_variate_block_size doubles.
+    holtsmark_variate_service(size_t consumers, double mu = 0, double c = 1, uint64_t seed = 0,
+        size_t blocks_per_consumer = 8, size_t producers = 1)
+        : mu(mu), c(c) {
+
+        if (blocks_per_consumer == 0) {
+            throw invalid_argument("holtsmark_variate_service: blocks_per_consumer must be positive");
+        }
+
+        producers = min(max(producers, (size_t)1), max(consumers, (size_t)1));
+        signals = make_unique<holtsmark_variate_signal[]>(producers);
+        producer_count = producers;
+
+        for (size_t k = 0; k < consumers; k++) {
+            channels.push_back(make_unique<consumer>(blocks_per_consumer, seed, k));
+            channels.back()->producer = &signals[k % producers];
+        }
+
+        for (size_t p = 0; p < producers; p++) {
+            workers.emplace_back([this, p, producers]() {
+                produce_loop(p, producers);
+            });
+        }
+    }
+
+    holtsmark_variate_service(const holtsmark_variate_service&) = delete;
+    holtsmark_variate_service& operator=(const holtsmark_variate_service&) = delete;
+
+    ~holtsmark_variate_service() {
+        stop.store(true, memory_order_relaxed);
+
+        for (size_t p = 0; p < producer_count; p++) {
+            signals[p].notify();
+        }
+
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    consumer& operator[](size_t k) {
+        return *channels[k];
+    }
+
+    size_t consumers() const {
+        return channels.size();
+    }
+
+    size_t memory_bytes() const {
+        size_t blocks = 0;
+        for (const unique_ptr<consumer>& channel : channels) {
+            blocks += channel->storage.size();
+        }
+
+        return blocks * sizeof(holtsmark_variate_block);
+    }
+
+private:
+    double mu, c;
+    vector<unique_ptr<consumer>> channels;
+    unique_ptr<holtsmark_variate_signal[]> signals;
+    size_t producer_count = 0;
+    vector<thread> workers;
+    atomic<bool> stop = false;
+
+    // producer p serves consumers p, p + producers, ...
+    // the signal is read before the scan, so a block freed during the scan ends the wait at once
+    void produce_loop(size_t p, size_t producers) {
+        atomic<uint32_t>& signal = signals[p].value;
+
+        for (;;) {
+            uint32_t seen = signal.load(memory_order_acquire);
+
+            if (stop.load(memory_order_relaxed)) {
+                return;
+            }
+
+            bool produced = false;
+
+            for (size_t k = p; k < channels.size(); k += producers) {
+                produced |= channels[k]->produce(mu, c);
+            }
+
+            if (!produced) {
+                signal.wait(seen, memory_order_acquire);
+            }
+        }
+    }
+};
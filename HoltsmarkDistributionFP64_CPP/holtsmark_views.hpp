@@ -0,0 +1,228 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// lazy range adaptors, evaluated in chunks as the range is consumed:
+//   x | holtsmark::views::pdf, x | holtsmark::views::cdf(mu, c), p | holtsmark::views::quantile,
+//   holtsmark::views::sample(engine, mu, c) | std::views::take(n)
+// the views are single pass input ranges that buffer one chunk, and compose with std::views.
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <ranges>
+#include <iterator>
+#include "holtsmark_batch.hpp"
+
+using namespace std;
+
+namespace holtsmark {
+    // elements per chunk
+    const size_t view_chunk = 64;
+
+    struct pdf_kernel {
+        double mu = 0, c = 1;
+
+        void operator()(span<double> x) const {
+            holtsmark_pdf_batch(x, x, mu, c);
+        }
+    };
+
+    struct cdf_kernel {
+        double mu = 0, c = 1;
+        bool complementary = false;
+
+        void operator()(span<double> x) const {
+            holtsmark_cdf_batch(x, x, mu, c, complementary);
+        }
+    };
+
+    struct quantile_kernel {
+        double mu = 0, c = 1;
+        bool complementary = false;
+
+        void operator()(span<double> p) const {
+            holtsmark_quantile_batch(p, p, mu, c, complementary);
+        }
+    };
+
+    // pulls up to view_chunk elements of the base range and transforms them with one kernel call
+    template <ranges::input_range V, class Kernel>
+        requires ranges::view<V> && convertible_to<ranges::range_reference_t<V>, double>
+    class chunked_view : public ranges::view_interface<chunked_view<V, Kernel>> {
+    public:
+        class iterator {
+        public:
+            using value_type = double;
+            using difference_type = ptrdiff_t;
+
+            iterator() = default;
+
+            explicit iterator(chunked_view* parent) : parent(parent) {}
+
+            double operator*() const {
+                return parent->buffer[parent->index];
+            }
+
+            iterator& operator++() {
+                if (++parent->index >= parent->count) {
+                    parent->refill();
+                }
+                return *this;
+            }
+
+            void operator++(int) {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, default_sentinel_t) {
+                return it.at_end();
+            }
+
+        private:
+            chunked_view* parent = nullptr;
+
+            bool at_end() const {
+                return parent->count == 0;
+            }
+        };
+
+        chunked_view() = default;
+
+        chunked_view(V base, Kernel kernel) : base(move(base)), kernel(kernel) {}
+
+        iterator begin() {
+            if (!started) {
+                current = ranges::begin(base);
+                started = true;
+                refill();
+            }
+            return iterator(this);
+        }
+
+        default_sentinel_t end() const {
+            return default_sentinel;
+        }
+
+    private:
+        V base = V();
+        Kernel kernel;
+        ranges::iterator_t<V> current;
+        array<double, view_chunk> buffer = {};
+        size_t index = 0, count = 0;
+        bool started = false;
+
+        void refill() {
+            index = count = 0;
+
+            for (; count < view_chunk && current != ranges::end(base); ++current) {
+                buffer[count++] = (double)*current;
+            }
+
+            kernel(span<double>(buffer.data(), count));
+        }
+    };
+
+    // infinite range of variates, refilled chunkwise by holtsmark_sample_batch
+    template <class Engine>
+    class sample_view : public ranges::view_interface<sample_view<Engine>> {
+    public:
+        class iterator {
+        public:
+            using value_type = double;
+            using difference_type = ptrdiff_t;
+
+            iterator() = default;
+
+            explicit iterator(sample_view* parent) : parent(parent) {}
+
+            double operator*() const {
+                return parent->buffer[parent->index];
+            }
+
+            iterator& operator++() {
+                if (++parent->index >= view_chunk) {
+                    parent->refill();
+                }
+                return *this;
+            }
+
+            void operator++(int) {
+                ++*this;
+            }
+
+        private:
+            sample_view* parent = nullptr;
+        };
+
+        sample_view() = default;
+
+        sample_view(Engine& engine, double mu, double c) : engine(&engine), mu(mu), c(c) {}
+
+        iterator begin() {
+            if (!started) {
+                started = true;
+                refill();
+            }
+            return iterator(this);
+        }
+
+        unreachable_sentinel_t end() const {
+            return unreachable_sentinel;
+        }
+
+    private:
+        Engine* engine = nullptr;
+        double mu = 0, c = 1;
+        array<double, view_chunk> buffer = {};
+        size_t index = 0;
+        bool started = false;
+
+        void refill() {
+            index = 0;
+            holtsmark_sample_batch(*engine, span<double>(buffer), mu, c);
+        }
+    };
+
+    namespace views {
+        template <class Kernel>
+        struct adaptor_closure {
+            Kernel kernel;
+
+            template <ranges::viewable_range R>
+            friend auto operator|(R&& r, const adaptor_closure& closure) {
+                return chunked_view<std::views::all_t<R>, Kernel>(std::views::all(forward<R>(r)), closure.kernel);
+            }
+        };
+
+        struct pdf_fn : adaptor_closure<pdf_kernel> {
+            adaptor_closure<pdf_kernel> operator()(double mu, double c) const {
+                return { pdf_kernel{ mu, c } };
+            }
+        };
+
+        struct cdf_fn : adaptor_closure<cdf_kernel> {
+            adaptor_closure<cdf_kernel> operator()(double mu, double c, bool complementary = false) const {
+                return { cdf_kernel{ mu, c, complementary } };
+            }
+        };
+
+        struct quantile_fn : adaptor_closure<quantile_kernel> {
+            adaptor_closure<quantile_kernel> operator()(double mu, double c, bool complementary = false) const {
+                return { quantile_kernel{ mu, c, complementary } };
+            }
+        };
+
+        inline constexpr pdf_fn pdf{};
+        inline constexpr cdf_fn cdf{};
+        inline constexpr quantile_fn quantile{};
+
+        // engine must return uniform 64-bit integers and outlive the view
+        template <class Engine>
+        sample_view<Engine> sample(Engine& engine, double mu = 0, double c = 1) {
+            return sample_view<Engine>(engine, mu, c);
+        }
+    }
+}
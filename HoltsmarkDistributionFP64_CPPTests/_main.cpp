@@ -0,0 +1,71 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// behaviour tests of the C++ implementation, returns nonzero when any check failed.
+// outside visual studio:
+//   g++ -std=c++20 -O2 -I../HoltsmarkDistributionFP64_CPP _main.cpp -o holtsmark_tests -pthread
+
+#include <iostream>
+#include "holtsmark_test.hpp"
+#include "nbody_tests.hpp"
+#include "likelihood_tests.hpp"
+#include "reduction_tests.hpp"
+#include "daemon_tests.hpp"
+#include "shm_ring_tests.hpp"
+#include "particle_filter_tests.hpp"
+#include "views_tests.hpp"
+#include "generator_tests.hpp"
+#include "manifest_tests.hpp"
+#include "tail_transform_tests.hpp"
+#include "adaptive_tests.hpp"
+#include "dedup_tests.hpp"
+#include "levy_path_tests.hpp"
+#include "kde_tests.hpp"
+#include "variate_service_tests.hpp"
+#include "bucketed_tests.hpp"
+#include "permute_tests.hpp"
+#include "autotune_tests.hpp"
+#include "sender_tests.hpp"
+#include "coalescer_tests.hpp"
+#include "divergence_tests.hpp"
+#include "scores_tests.hpp"
+#include "expectation_tests.hpp"
+#include "monte_carlo_tests.hpp"
+#include "shadow_tests.hpp"
+
+int main() {
+    run_test("nbody", test_nbody);
+    run_test("likelihood", test_likelihood);
+    run_test("reduction", test_reduction);
+    run_test("daemon", test_daemon);
+    run_test("shm_ring", test_shm_ring);
+    run_test("particle_filter", test_particle_filter);
+    run_test("views", test_views);
+    run_test("generator", test_generator);
+    run_test("manifest", test_manifest);
+    run_test("tail_transform", test_tail_transform);
+    run_test("adaptive", test_adaptive);
+    run_test("dedup", test_dedup);
+    run_test("levy_path", test_levy_path);
+    run_test("kde", test_kde);
+    run_test("variate_service", test_variate_service);
+    run_test("bucketed", test_bucketed);
+    run_test("permute", test_permute);
+    run_test("autotune", test_autotune);
+    run_test("sender", test_sender);
+    run_test("coalescer", test_coalescer);
+    run_test("divergence", test_divergence);
+    run_test("scores", test_scores);
+    run_test("expectation", test_expectation);
+    run_test("monte_carlo", test_monte_carlo);
+    run_test("shadow", test_shadow);
+
+    const holtsmark_test_state& state = holtsmark_tests();
+
+    cout << state.checks << " checks, " << state.failures << " failures in "
+        << state.failed_tests << " tests" << endl;
+
+    return state.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_adaptive.hpp"
+
+#include <random>
+#include <vector>
+
+// the reported bound of the fast tier holds against the double kernels
+void test_adaptive_bounds() {
+    double pdf_worst = 0, cdf_worst = 0;
+
+    for (double x = -64; x <= 64; x += 1. / 1024 + 1e-7) {
+        double bound;
+
+        double pdf = holtsmark_pdf_fast(x, bound), expected = holtsmark_pdf(x);
+        pdf_worst = max(pdf_worst, abs(pdf - expected) / expected / bound);
+
+        for (bool complementary : { false, true }) {
+            double cdf = holtsmark_cdf_fast(x, bound, complementary);
+            expected = holtsmark_cdf(x, complementary);
+            cdf_worst = max(cdf_worst, abs(cdf - expected) / expected / bound);
+        }
+    }
+
+    check(pdf_worst <= 1, "pdf error within the bound, worst ratio " + to_string(pdf_worst));
+    check(cdf_worst <= 1, "cdf error within the bound, worst ratio " + to_string(cdf_worst));
+
+    double bound;
+    holtsmark_pdf_fast(65, bound);
+    check(bound == numeric_limits<double>::infinity(), "|x| > 64 has no fast bound");
+    holtsmark_cdf_fast(numeric_limits<double>::quiet_NaN(), bound);
+    check(!(bound <= 1), "nan has no fast bound");
+}
+
+// results meet the tolerance, and exactly the points over it are escalated
+void test_adaptive_batch() {
+    const size_t n = 5000;
+    const double mu = 0.5, c = 2, tolerance = 1e-8;
+
+    mt19937_64 engine(9);
+    uniform_real_distribution<double> uniform(-180, 180);
+
+    vector<double> x(n), y(n);
+    for (double& v : x) {
+        v = uniform(engine);
+    }
+
+    size_t escalated = holtsmark_pdf_adaptive_batch(x, y, tolerance, mu, c);
+
+    size_t expected_escalated = 0, violations = 0;
+    for (size_t i = 0; i < n; i++) {
+        double u = (x[i] - mu) * (1 / c), bound;
+        holtsmark_pdf_fast(u, bound);
+        expected_escalated += !(bound <= tolerance) ? 1 : 0;
+
+        double expected = holtsmark_pdf(u) / c;
+        violations += (abs(y[i] - expected) > tolerance * expected) ? 1 : 0;
+    }
+
+    check(escalated == expected_escalated, "pdf escalated " + to_string(escalated) + " of " + to_string(expected_escalated));
+    check(violations == 0, "pdf within tolerance");
+
+    for (bool complementary : { false, true }) {
+        holtsmark_cdf_adaptive_batch(x, y, tolerance, mu, c, complementary);
+
+        violations = 0;
+        for (size_t i = 0; i < n; i++) {
+            double expected = holtsmark_cdf((x[i] - mu) * (1 / c), complementary);
+            violations += (abs(y[i] - expected) > tolerance * expected) ? 1 : 0;
+        }
+        check(violations == 0, string("cdf within tolerance, complementary ") + (complementary ? "true" : "false"));
+    }
+}
+
+// tolerance 0 escalates every point and returns the double kernel results
+void test_adaptive_exact() {
+    vector<double> x = { -70, -3, -0.25, 0, 0.5, 7, 63.9, 1e6 }, y(x.size()), expected(x.size());
+
+    check(holtsmark_pdf_adaptive_batch(x, y, 0) == x.size(), "pdf all escalated");
+    for (size_t i = 0; i < x.size(); i++) {
+        check(y[i] == holtsmark_pdf(x[i]), "pdf exact at " + to_string(x[i]));
+    }
+
+    check(holtsmark_cdf_adaptive_batch(x, y, 0, 0, 1, true) == x.size(), "cdf all escalated");
+    holtsmark_cdf_batch(x, expected, 0, 1, true);
+    check(y == expected, "cdf exact");
+}
+
+void test_adaptive() {
+    test_adaptive_bounds();
+    test_adaptive_batch();
+    test_adaptive_exact();
+}
@@ -0,0 +1,72 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_autotune.hpp"
+#include "bucketed_tests.hpp"
+
+#include <sstream>
+#include <filesystem>
+
+// every strategy gives the plain batch results
+void test_autotune_dispatch() {
+    holtsmark_tuning saved = holtsmark_active_tuning();
+
+    vector<double> x = segment_mixed_inputs(3000, 21), y(x.size()), expected(x.size());
+
+    for (holtsmark_strategy strategy : { holtsmark_strategy::plain, holtsmark_strategy::bucketed, holtsmark_strategy::permute }) {
+        holtsmark_active_tuning() = { strategy, strategy, holtsmark_strategy::plain };
+
+        string tag = " strategy " + to_string((int)strategy);
+
+        holtsmark_pdf_tuned_batch(x, y, 1, 2);
+        holtsmark_pdf_batch(x, expected, 1, 2);
+        check(y == expected, "pdf" + tag);
+
+        holtsmark_cdf_tuned_batch(x, y, 1, 2, true);
+        holtsmark_cdf_batch(x, expected, 1, 2, true);
+        check(y == expected, "ccdf" + tag);
+    }
+
+    holtsmark_active_tuning() = saved;
+
+    vector<double> p = { 1e-300, 0.01, 0.5, 0.99 }, q(p.size()), q_expected(p.size());
+    holtsmark_quantile_tuned_batch(p, q, 0, 1, true);
+    holtsmark_quantile_batch(p, q_expected, 0, 1, true);
+    check(q == q_expected, "quantile");
+}
+
+// a short tuning run and its header
+void test_autotune_header() {
+    ostringstream log;
+    holtsmark_tuning tuning = holtsmark_autotune(1024, 1, &log);
+
+    auto valid = [](holtsmark_strategy s) { return (int)s >= 0 && (int)s <= 2; };
+    check(valid(tuning.pdf) && valid(tuning.cdf) && tuning.quantile == holtsmark_strategy::plain, "strategies");
+    check(log.str().find("pdf strategy 2") != string::npos && log.str().find("cdf strategy 0") != string::npos, "log of every strategy");
+
+    filesystem::path path = filesystem::temp_directory_path() / "holtsmark_tuning_test.hpp";
+    holtsmark_write_tuning_header(path.string(), { holtsmark_strategy::permute, holtsmark_strategy::bucketed, holtsmark_strategy::plain });
+
+    ifstream ifs(path);
+    stringstream content;
+    content << ifs.rdbuf();
+    ifs.close();
+    filesystem::remove(path);
+
+    check(content.str().find("#pragma once") != string::npos, "pragma once");
+    check(content.str().find("#define HOLTSMARK_TUNED_PDF 2\n") != string::npos, "pdf define");
+    check(content.str().find("#define HOLTSMARK_TUNED_CDF 1\n") != string::npos, "cdf define");
+    check(content.str().find("#define HOLTSMARK_TUNED_QUANTILE 0\n") != string::npos, "quantile define");
+
+    check(filesystem::path(holtsmark_tuning_header_path()).filename() == "holtsmark_tuning.hpp", "default header name");
+}
+
+void test_autotune() {
+    test_autotune_dispatch();
+    test_autotune_header();
+}
@@ -0,0 +1,81 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_bucketed.hpp"
+
+#include <random>
+#include <vector>
+#include <limits>
+
+// every segment: both sides of each power of two boundary, random magnitudes,
+// signed zeros, the limit range and infinity, shuffled so blocks mix segments
+vector<double> segment_mixed_inputs(size_t n, uint64_t seed) {
+    mt19937_64 engine(seed);
+
+    vector<double> x = { 0.0, -0.0, numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(), 1e300, -1e300 };
+
+    for (int k = -4; k <= 8; k++) {
+        double b = ldexp(1, k);
+        for (double v : { nextafter(b, 0.0), b, nextafter(b, 1e9) }) {
+            x.push_back(v);
+            x.push_back(-v);
+        }
+    }
+
+    uniform_real_distribution<double> exponent(-6, 12), sign(-1, 1);
+    while (x.size() < n) {
+        x.push_back(copysign(exp2(exponent(engine)), sign(engine)));
+    }
+
+    shuffle(x.begin(), x.end(), engine);
+    x.resize(n);
+
+    return x;
+}
+
+// pdf and cdf bit-identical to the plain batch kernels for every block size and location-scale
+void test_bucketed_identical() {
+    for (size_t n : { 1, 63, 64, 65, 1000, 5000 }) {
+        vector<double> x = segment_mixed_inputs(n, n), y(n), expected(n);
+
+        for (auto [mu, c] : { pair{ 0.0, 1.0 }, pair{ 0.75, 3.0 }, pair{ -2.0, 0.125 } }) {
+            string tag = " n=" + to_string(n) + " mu=" + to_string(mu) + " c=" + to_string(c);
+
+            holtsmark_pdf_bucketed_batch(x, y, mu, c);
+            holtsmark_pdf_batch(x, expected, mu, c);
+            check(y == expected, "pdf" + tag);
+
+            for (bool complementary : { false, true }) {
+                holtsmark_cdf_bucketed_batch(x, y, mu, c, complementary);
+                holtsmark_cdf_batch(x, expected, mu, c, complementary);
+                check(y == expected, string(complementary ? "ccdf" : "cdf") + tag);
+            }
+        }
+    }
+}
+
+// one segment only, and sorted inputs
+void test_bucketed_uniform_blocks() {
+    vector<double> same(3000, 2.5), sorted = segment_mixed_inputs(3000, 1), y(3000), expected(3000);
+    sort(sorted.begin(), sorted.end());
+
+    for (const vector<double>& x : { same, sorted }) {
+        holtsmark_pdf_bucketed_batch(x, y);
+        holtsmark_pdf_batch(x, expected);
+        check(y == expected, "pdf");
+
+        holtsmark_cdf_bucketed_batch(x, y);
+        holtsmark_cdf_batch(x, expected);
+        check(y == expected, "cdf");
+    }
+}
+
+void test_bucketed() {
+    test_bucketed_identical();
+    test_bucketed_uniform_blocks();
+}
@@ -0,0 +1,69 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_coalescer.hpp"
+
+#include <vector>
+#include <thread>
+
+// a lone caller is answered directly, both tails bit-identical to holtsmark_cdf
+void test_coalescer_single() {
+    holtsmark_cdf_coalescer coalescer;
+
+    bool same = true;
+    for (double x = -100; x <= 100; x += 0.37) {
+        same = same && coalescer(x) == holtsmark_cdf(x) && coalescer(x, true) == holtsmark_cdf(x, true);
+        same = same && coalescer.submit(x, true).get() == holtsmark_cdf(x, true);
+    }
+    check(same, "scalar results");
+
+    holtsmark_coalescer_counters counters = coalescer.counters();
+    check(counters.coalesced == 0 && counters.batches == 0 && counters.direct > 0, "all direct");
+}
+
+// concurrent callers on shared shards get their own results, every call is counted once
+void test_coalescer_concurrent() {
+    const size_t threads = 8, calls = 3000;
+
+    holtsmark_cdf_coalescer coalescer(chrono::microseconds(50), 64, 2);
+
+    vector<size_t> mismatches(threads, 0);
+    vector<thread> workers;
+
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = 0; i < calls; i++) {
+                double x = (double)((t * calls + i) % 1001) * 0.1 - 50;
+                bool complementary = (i % 3) == 0;
+
+                double y = (i % 5 == 0) ? coalescer.submit(x, complementary).get() : coalescer(x, complementary);
+
+                mismatches[t] += (y != holtsmark_cdf(x, complementary)) ? 1 : 0;
+            }
+        });
+    }
+
+    for (thread& w : workers) {
+        w.join();
+    }
+
+    size_t total = 0;
+    for (size_t m : mismatches) {
+        total += m;
+    }
+    check(total == 0, "results of concurrent callers, mismatches " + to_string(total));
+
+    holtsmark_coalescer_counters counters = coalescer.counters();
+    check(counters.direct + counters.coalesced == threads * calls, "every call counted once");
+    check(counters.batches <= counters.coalesced, "batches hold their callers");
+}
+
+void test_coalescer() {
+    test_coalescer_single();
+    test_coalescer_concurrent();
+}
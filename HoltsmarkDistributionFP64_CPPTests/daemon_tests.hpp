@@ -0,0 +1,128 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_daemon.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+
+// a client that disconnects in the middle of a large response must only lose its own connection.
+// without SIGPIPE protection the whole test process dies with exit code 141.
+void test_daemon_client_disconnect() {
+    const string path = "/tmp/holtsmark_daemon_disconnect_test.sock";
+
+    holtsmark_daemon daemon(path, 1);
+    thread server([&]() { daemon.run(); });
+
+    for (int round = 0; round < 4; round++) {
+        int fd = holtsmark_daemon_connect(path);
+        check(fd >= 0, "connect");
+        if (fd < 0) {
+            break;
+        }
+
+        // 2^22 samples, 32 MiB of response, far beyond the socket buffer
+        holtsmark_daemon_request request{ holtsmark_daemon_sample, 0, 0, 1u << 22, 0, 1, (uint64_t)round };
+        send(fd, &request, sizeof(request), 0);
+
+        // read part of the response, then go away with the rest unread
+        vector<uint8_t> buffer(4096);
+        recv(fd, buffer.data(), buffer.size(), 0);
+        close(fd);
+
+        this_thread::sleep_for(chrono::milliseconds(200));
+    }
+
+    // the daemon still serves other clients
+    int fd = holtsmark_daemon_connect(path);
+    vector<double> x = { -2, 0, 3 }, y;
+
+    holtsmark_daemon_request request{ holtsmark_daemon_pdf, 0, 0, (uint32_t)x.size(), 0, 1, 0 };
+    bool answered = fd >= 0 && holtsmark_daemon_call(fd, request, x, y) && y.size() == x.size();
+
+    check(answered, "daemon answers after the disconnects");
+    if (answered) {
+        for (size_t i = 0; i < x.size(); i++) {
+            check(y[i] == holtsmark_pdf(x[i]), "pdf at " + to_string(x[i]));
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    daemon.stop();
+    server.join();
+}
+
+// a client that pipelines requests without reading holds the daemon at the high-water mark,
+// and still gets every response in order once it reads
+void test_daemon_output_backpressure() {
+    const string path = "/tmp/holtsmark_daemon_backpressure_test.sock";
+    const uint32_t count = 1u << 20, requests = 48;
+
+    holtsmark_daemon daemon(path, 2);
+
+    int fd = holtsmark_daemon_connect(path);
+    check(fd >= 0, "connect");
+    if (fd < 0) {
+        return;
+    }
+
+    // 48 x 8 MiB of responses for 1.5 KiB of requests
+    for (uint32_t i = 0; i < requests; i++) {
+        holtsmark_daemon_request request{ holtsmark_daemon_sample, 0, 0, count, 0, 1, i };
+        send(fd, &request, sizeof(request), 0);
+    }
+
+    size_t peak = 0;
+    for (int round = 0; round < 50; round++) {
+        daemon.poll_once(10);
+        peak = max(peak, daemon.queued_bytes());
+    }
+
+    size_t response_bytes = sizeof(holtsmark_daemon_response) + count * sizeof(double);
+
+    check(peak >= holtsmark_daemon::output_high_water, "responses were queued");
+    check(peak < holtsmark_daemon::output_high_water + response_bytes, "queued bytes bounded, peak " + to_string(peak));
+
+    thread server([&]() { daemon.run(); });
+
+    bool in_order = true;
+    vector<double> values(count), expected(count);
+    for (uint32_t i = 0; i < requests && in_order; i++) {
+        holtsmark_daemon_response response{};
+        in_order = recv(fd, &response, sizeof(response), MSG_WAITALL) == (ssize_t)sizeof(response)
+            && response.status == holtsmark_daemon_ok && response.count == count
+            && recv(fd, values.data(), count * sizeof(double), MSG_WAITALL) == (ssize_t)(count * sizeof(double));
+
+        mt19937_64 engine(i);
+        holtsmark_sample_batch(engine, expected);
+        in_order = in_order && values == expected;
+    }
+    check(in_order, "every response, in order");
+
+    close(fd);
+    daemon.stop();
+    server.join();
+}
+
+void test_daemon() {
+    test_daemon_client_disconnect();
+    test_daemon_output_backpressure();
+}
+
+#else
+
+void test_daemon() {}
+
+#endif
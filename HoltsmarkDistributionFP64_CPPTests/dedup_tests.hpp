@@ -0,0 +1,96 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_dedup.hpp"
+
+#include <random>
+#include <vector>
+
+// quantized data: k distinct levels repeated over n elements
+vector<double> dedup_levels(size_t n, size_t k, uint64_t seed) {
+    mt19937_64 engine(seed);
+
+    vector<double> x(n);
+    for (double& v : x) {
+        v = -20 + 40 * (double)(engine() % k) / (double)k;
+    }
+
+    return x;
+}
+
+void test_dedup_cardinality() {
+    check(holtsmark_distinct_fraction({}) == 1, "empty");
+
+    vector<double> small = { 1, 2, 2, 3, 3, 3, 4, 4 };
+    check(holtsmark_distinct_fraction(small) == 0.5, "exact for small arrays");
+
+    vector<double> distinct(200000);
+    for (size_t i = 0; i < distinct.size(); i++) {
+        distinct[i] = (double)i;
+    }
+    check(holtsmark_distinct_fraction(distinct) > 0.5, "all distinct");
+
+    for (size_t k : { 100, 2000, 20000 }) {
+        vector<double> x = dedup_levels(1000000, k, k);
+        double estimate = holtsmark_distinct_fraction(x) * (double)x.size();
+
+        check(estimate > 0.8 * (double)k && estimate < 1.25 * (double)k,
+            "cardinality " + to_string(k) + " estimated " + to_string(estimate));
+    }
+}
+
+// deduplicated results are the plain batch results, evaluated once per distinct value
+void test_dedup_batch() {
+    vector<double> x = dedup_levels(100000, 300, 1), y(x.size()), expected(x.size());
+
+    size_t evaluations = holtsmark_pdf_dedup_batch(x, y, 0.5, 2);
+    holtsmark_pdf_batch(x, expected, 0.5, 2);
+
+    check(evaluations == 300, "pdf evaluations " + to_string(evaluations));
+    check(y == expected, "pdf bit-identical to the plain batch");
+
+    evaluations = holtsmark_cdf_dedup_batch(x, y, 0, 1, true);
+    holtsmark_cdf_batch(x, expected, 0, 1, true);
+
+    check(evaluations == 300, "ccdf evaluations " + to_string(evaluations));
+    check(y == expected, "ccdf bit-identical to the plain batch");
+
+    // high cardinality takes the plain kernel
+    vector<double> z = dedup_levels(100000, (size_t)1 << 40, 2);
+    check(holtsmark_pdf_dedup_batch(z, y) == z.size(), "high cardinality not deduplicated");
+
+    // a wrong low cardinality hint gives up at the limit and still returns the right values
+    check(holtsmark_pdf_dedup_batch(z, y, 0, 1, holtsmark_dedup_hint::low_cardinality) == z.size(), "wrong hint falls back");
+    holtsmark_pdf_batch(z, expected);
+    check(y == expected, "wrong hint results");
+
+    check(holtsmark_pdf_dedup_batch(x, y, 0, 1, holtsmark_dedup_hint::high_cardinality) == x.size(), "high cardinality hint");
+}
+
+void test_dedup_code_table() {
+    holtsmark_code_table table(holtsmark_code_table::kind::cdf, -100, 100, 0.5, 0.25, 1, 2);
+    check(table.size() == 201, "table size");
+
+    vector<int32_t> codes = { -100, -1, 0, 1, 100, -101, 101, 1 << 30, INT32_MIN };
+    vector<double> y(codes.size()), x(codes.size()), expected(codes.size());
+
+    for (size_t i = 0; i < codes.size(); i++) {
+        x[i] = 0.5 + 0.25 * (double)codes[i];
+    }
+
+    table(codes, y);
+    holtsmark_cdf_batch(x, expected, 1, 2, false);
+
+    check(y == expected, "codes in and out of the table range");
+}
+
+void test_dedup() {
+    test_dedup_cardinality();
+    test_dedup_batch();
+    test_dedup_code_table();
+}
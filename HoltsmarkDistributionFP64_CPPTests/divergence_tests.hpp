@@ -0,0 +1,95 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_divergence.hpp"
+
+#include <vector>
+
+// E[g(t)], t ~ holtsmark(0, 1), by simpson's rule in u = log |t| on both sides.
+// independent of the quadrature module, slow but accurate to ~1e-12 for smooth g.
+template <class Func>
+double divergence_simpson_expectation(Func g) {
+    const double u0 = -40, u1 = 60;
+    const size_t n = 200000;
+    const double h = (u1 - u0) / (double)n;
+
+    double s = 0;
+    for (size_t i = 0; i <= n; i++) {
+        double t = exp(u0 + h * (double)i);
+        double w = (i == 0 || i == n) ? 1 : (i % 2 == 1) ? 4 : 2;
+
+        s += w * holtsmark_pdf(t) * t * (g(t) + g(-t));
+    }
+
+    return s * h / 3;
+}
+
+// the entropy constant is -E[logpdf(t)]
+void test_divergence_entropy() {
+    double entropy = -divergence_simpson_expectation([](double t) { return holtsmark_logpdf(t); });
+
+    check_near(entropy, holtsmark_entropy_base, 1e-12, "entropy constant by simpson");
+    check_near(-holtsmark_expected_logpdf(0, 1), holtsmark_entropy_base, 1e-13, "entropy constant by the expectation rule");
+    check_near(holtsmark_entropy(3), holtsmark_entropy_base + log(3.0), 1e-15, "entropy scales by log c");
+}
+
+// KL(P, P) = 0 before the clamp, for any location and scale
+void test_divergence_self() {
+    for (auto [mu, c] : { pair{ 0.0, 1.0 }, pair{ 5.0, 0.01 }, pair{ -3.0, 250.0 } }) {
+        double h = holtsmark_cross_entropy(mu, c, mu, c);
+
+        check(abs(h - holtsmark_entropy(c)) < 1e-12 * max(1.0, abs(h)),
+            "H(P, P) = H(P) at mu=" + to_string(mu) + " c=" + to_string(c));
+        check(holtsmark_kl_divergence(mu, c, mu, c) < 1e-12, "KL(P, P) = 0");
+    }
+}
+
+// cross-entropy of unequal pairs against simpson's rule, invariance and monotonicity of KL
+void test_divergence_pairs() {
+    for (auto [d, r] : { pair{ 1.5, 2.0 }, pair{ -4.0, 0.5 }, pair{ 30.0, 1.0 } }) {
+        double expected = -divergence_simpson_expectation([=](double t) { return holtsmark_logpdf(d + r * t); });
+
+        check_near(-holtsmark_expected_logpdf(d, r), expected, 1e-10, "E[logpdf(d + r t)] at d=" + to_string(d) + " r=" + to_string(r));
+    }
+
+    // KL is invariant under a common location-scale map
+    double kl = holtsmark_kl_divergence(1, 2, -3, 0.5);
+    check_near(holtsmark_kl_divergence(0, 1, -2, 0.25), kl, 1e-12, "location-scale invariance");
+    check_near(holtsmark_kl_divergence(10, 20, -30, 5), kl, 1e-12, "scaled by 10");
+
+    double previous = 0;
+    bool increasing = true;
+    for (double shift : { 0.5, 1.0, 2.0, 4.0, 8.0 }) {
+        double v = holtsmark_kl_divergence(0, 1, shift, 1);
+        increasing = increasing && v > previous;
+        previous = v;
+    }
+    check(increasing, "KL grows with the location shift");
+}
+
+void test_divergence_batch() {
+    vector<double> mu1 = { 0, 1, -2, 5 }, c1 = { 1, 2, 0.5, 3 }, mu2 = { 0, -1, 2, 5 }, c2 = { 1, 1, 4, 3 };
+    vector<double> h(4), kl(4);
+
+    holtsmark_cross_entropy_batch(mu1, c1, mu2, c2, h, 3);
+    holtsmark_kl_divergence_batch(mu1, c1, mu2, c2, kl, 2);
+
+    bool same = true;
+    for (size_t i = 0; i < 4; i++) {
+        same = same && h[i] == holtsmark_cross_entropy(mu1[i], c1[i], mu2[i], c2[i]);
+        same = same && kl[i] == holtsmark_kl_divergence(mu1[i], c1[i], mu2[i], c2[i]);
+    }
+    check(same, "batch equals scalar");
+}
+
+void test_divergence() {
+    test_divergence_entropy();
+    test_divergence_self();
+    test_divergence_pairs();
+    test_divergence_batch();
+}
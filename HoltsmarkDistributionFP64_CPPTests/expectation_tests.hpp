@@ -0,0 +1,93 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_expectation.hpp"
+#include "divergence_tests.hpp"
+
+#include <vector>
+#include <stdexcept>
+
+// every rule integrates 1 and the first moment, order 8 to ~1e-13
+void test_expectation_moments() {
+    for (size_t order : holtsmark_rule_orders) {
+        string tag = " order " + to_string(order);
+        double tol = (order == 8) ? 1e-12 : 1e-14;
+
+        check_near(holtsmark_expectation([](double) { return 1.0; }, 0, 1, order), 1, tol, "E[1]" + tag);
+        check_near(holtsmark_expectation([](double x) { return x; }, 3, 2, order), 3, tol, "E[X] = mu" + tag);
+    }
+}
+
+// smooth and log growing integrands against simpson's rule in log |x|
+void test_expectation_accuracy() {
+    auto lorentz = [](double x) { return 1 / (1 + x * x); };
+    auto log_growth = [](double x) { return log1p(abs(x)); };
+    auto shifted = [](double x) { return exp(-(x - 1) * (x - 1)); };
+
+    double lorentz_expected = divergence_simpson_expectation(lorentz);
+    double log_expected = divergence_simpson_expectation(log_growth);
+
+    // the kink of log1p|x| and the peak of the gaussian lie on the breaks 0 and 1
+    check_near(holtsmark_expectation(lorentz), lorentz_expected, 1e-13, "E[1 / (1 + X^2)], order 12");
+    check_near(holtsmark_expectation(log_growth), log_expected, 1e-13, "E[log(1 + |X|)], order 12");
+    check_near(holtsmark_expectation(lorentz, 0, 1, 8), lorentz_expected, 1e-9, "E[1 / (1 + X^2)], order 8");
+    check_near(holtsmark_expectation(shifted, 0, 1, 24), divergence_simpson_expectation(shifted), 1e-12, "E[exp(-(X - 1)^2)], order 24");
+
+    // location and scale: E[f(mu + c T)], the peak of f at t = -2/3 is off the breaks,
+    // so the error shrinks with the order
+    double expected = divergence_simpson_expectation([](double t) { return 1 / (1 + (2 + 3 * t) * (2 + 3 * t)); });
+    check_near(holtsmark_expectation(lorentz, 2, 3, 12), expected, 1e-6, "location and scale, order 12");
+    check_near(holtsmark_expectation(lorentz, 2, 3, 16), expected, 1e-8, "location and scale, order 16");
+    check_near(holtsmark_expectation(lorentz, 2, 3, 24), expected, 1e-12, "location and scale, order 24");
+}
+
+void test_expectation_batch() {
+    vector<double> y(3);
+
+    holtsmark_expectation_batch([](size_t k, span<const double> x, span<double> fx) {
+        for (size_t i = 0; i < x.size(); i++) {
+            fx[i] = 1 / (1 + (double)(k + 1) * x[i] * x[i]);
+        }
+    }, y, 0.5, 2, 16, 2);
+
+    bool same = true;
+    for (size_t k = 0; k < y.size(); k++) {
+        same = same && y[k] == holtsmark_expectation([&](double x) { return 1 / (1 + (double)(k + 1) * x * x); }, 0.5, 2, 16);
+    }
+    check(same, "batch equals scalar");
+}
+
+// unsupported orders throw, also in release builds
+void test_expectation_order() {
+    for (size_t order : { 0, 10, 32 }) {
+        bool thrown = false;
+        try {
+            holtsmark_gauss_rule(order);
+        }
+        catch (const invalid_argument&) {
+            thrown = true;
+        }
+        check(thrown, "order " + to_string(order) + " refused");
+    }
+
+    bool thrown = false;
+    try {
+        holtsmark_expectation([](double x) { return x; }, 0, 1, 7);
+    }
+    catch (const invalid_argument&) {
+        thrown = true;
+    }
+    check(thrown, "holtsmark_expectation refuses order 7");
+}
+
+void test_expectation() {
+    test_expectation_moments();
+    test_expectation_accuracy();
+    test_expectation_batch();
+    test_expectation_order();
+}
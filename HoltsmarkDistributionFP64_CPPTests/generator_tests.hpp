@@ -0,0 +1,99 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_generator.hpp"
+
+#include <random>
+#include <vector>
+
+// known answers of philox4x32-10 from the Random123 distribution (kat_vectors)
+void test_generator_philox_kat() {
+    using block = array<uint32_t, 4>;
+
+    check(philox_engine::philox4x32_10({ 0u, 0u, 0u, 0u }, 0u, 0u)
+        == block{ 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u }, "zero counter and key");
+    check(philox_engine::philox4x32_10({ ~0u, ~0u, ~0u, ~0u }, ~0u, ~0u)
+        == block{ 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu }, "all ones");
+    check(philox_engine::philox4x32_10({ 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u }, 0xa4093822u, 0x299f31d0u)
+        == block{ 0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u }, "digits of pi");
+
+    philox_engine engine;
+    check(engine() == 0x6627e8d5e169c58dull && engine() == 0xbc57ac4c9b00dbd8ull, "engine output of block 0");
+}
+
+// output i is a pure function of (key, i)
+void test_generator_philox_seek() {
+    static_assert(uniform_random_bit_generator<philox_engine>);
+
+    philox_engine engine(42);
+    vector<uint64_t> v(9);
+    for (uint64_t& r : v) {
+        r = engine();
+    }
+    check(engine.tell() == 9 && engine.stream() == 42, "tell");
+
+    bool same = true;
+    for (uint64_t i = 0; i < v.size(); i++) {
+        philox_engine positioned(42, i);
+        same = same && positioned() == v[i];
+    }
+    check(same, "seek");
+
+    philox_engine skipped(42);
+    skipped();
+    skipped.discard(4);
+    check(skipped() == v[5], "discard");
+
+    check(philox_engine(43)() != v[0], "streams differ by key");
+}
+
+// the stream yields the refill blocks of the batch sampler in order
+void test_generator_sample_stream() {
+    const size_t refill = 100;
+
+    philox_engine reference(7);
+    vector<double> expected(3 * refill);
+    for (size_t k = 0; k < 3; k++) {
+        holtsmark_sample_batch(reference, span<double>(expected).subspan(k * refill, refill), 1, 2);
+    }
+
+    holtsmark::generator<double> stream = holtsmark::sample_stream(philox_engine(7), 1, 2, refill);
+
+    bool same = true;
+    for (size_t i = 0; i < expected.size(); i++) {
+        same = same && stream() == expected[i];
+    }
+    check(same, "stream matches the refill blocks");
+
+    size_t count = 0;
+    for (double x : holtsmark::sample_stream(mt19937_64(1))) {
+        if (!isfinite(x) || ++count >= 2500) {
+            break;
+        }
+    }
+    check(count == 2500, "iteration across refills");
+}
+
+// refill 0 is clamped to 1 instead of spinning on an empty buffer
+void test_generator_zero_refill() {
+    holtsmark::generator<double> zero = holtsmark::sample_stream(philox_engine(3), 0, 1, 0);
+    holtsmark::generator<double> one = holtsmark::sample_stream(philox_engine(3), 0, 1, 1);
+
+    bool same = true;
+    for (int i = 0; i < 10; i++) {
+        same = same && zero() == one();
+    }
+    check(same, "refill 0 behaves as refill 1");
+}
+
+void test_generator() {
+    test_generator_philox_kat();
+    test_generator_philox_seek();
+    test_generator_sample_stream();
+    test_generator_zero_refill();
+}
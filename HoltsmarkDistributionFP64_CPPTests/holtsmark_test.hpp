@@ -0,0 +1,64 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+// minimal checks for the C++ tests: failures are counted and printed with their location,
+// _main.cpp runs every test and returns nonzero when any check failed.
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <source_location>
+
+using namespace std;
+
+struct holtsmark_test_state {
+    string current;
+    size_t checks = 0, failures = 0, failed_tests = 0;
+};
+
+holtsmark_test_state& holtsmark_tests() {
+    static holtsmark_test_state state;
+
+    return state;
+}
+
+void check(bool condition, const string& what, source_location location = source_location::current()) {
+    holtsmark_test_state& state = holtsmark_tests();
+
+    state.checks++;
+
+    if (!condition) {
+        state.failures++;
+        cout << "  FAILED " << state.current << ": " << what
+            << " (" << location.file_name() << ":" << location.line() << ")" << endl;
+    }
+}
+
+// |actual - expected| <= tolerance |expected|, or both the same infinity / nan
+void check_near(double actual, double expected, double tolerance, const string& what,
+    source_location location = source_location::current()) {
+
+    bool ok = (actual == expected)
+        || (isnan(actual) && isnan(expected))
+        || (abs(actual - expected) <= tolerance * abs(expected));
+
+    check(ok, what + ": " + to_string(actual) + " vs " + to_string(expected), location);
+}
+
+void run_test(const string& name, void (*test)()) {
+    holtsmark_test_state& state = holtsmark_tests();
+
+    state.current = name;
+    size_t failures = state.failures;
+
+    test();
+
+    bool passed = state.failures == failures;
+    state.failed_tests += passed ? 0 : 1;
+
+    cout << (passed ? "passed " : "FAILED ") << name << endl;
+}
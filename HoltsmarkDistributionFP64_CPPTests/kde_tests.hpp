@@ -0,0 +1,116 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_kde.hpp"
+
+#include <random>
+#include <vector>
+#include <limits>
+
+vector<double> kde_samples(size_t n, uint64_t seed) {
+    mt19937_64 engine(seed);
+
+    vector<double> x(n);
+    holtsmark_sample_batch(engine, x, 0.5, 2);
+
+    return x;
+}
+
+vector<double> kde_direct(span<const double> samples, span<const double> queries, double h) {
+    vector<double> density(queries.size());
+
+    for (size_t q = 0; q < queries.size(); q++) {
+        double s = 0;
+        for (double x : samples) {
+            s += holtsmark_pdf((queries[q] - x) / h) / h;
+        }
+        density[q] = s / (double)samples.size();
+    }
+
+    return density;
+}
+
+// the tiled estimate against a double loop, independent of the thread count
+void test_kde_direct() {
+    vector<double> samples = kde_samples(3000, 1), queries(200);
+    for (size_t q = 0; q < queries.size(); q++) {
+        queries[q] = -40 + 0.4 * (double)((q * 37) % 200);
+    }
+
+    vector<double> density = holtsmark_kde(samples, queries, 0.3, 0, 1);
+    vector<double> density3 = holtsmark_kde(samples, queries, 0.3, 0, 3);
+    vector<double> expected = kde_direct(samples, queries, 0.3);
+
+    check(density == density3, "1 vs 3 threads");
+
+    double max_error = 0;
+    for (size_t q = 0; q < queries.size(); q++) {
+        max_error = max(max_error, abs(density[q] - expected[q]) / expected[q]);
+    }
+    check(max_error < 1e-12, "direct sum, max rel. error " + to_string(max_error));
+}
+
+// truncation skips at most tolerance per query
+void test_kde_truncated() {
+    const double tolerance = 1e-6, h = 0.2;
+
+    vector<double> samples = kde_samples(20000, 2), queries(500);
+    mt19937_64 engine(3);
+    uniform_real_distribution<double> uniform(-100, 100);
+    for (double& q : queries) {
+        q = uniform(engine);
+    }
+
+    vector<double> exact = holtsmark_kde(samples, queries, h);
+    vector<double> truncated = holtsmark_kde(samples, queries, h, tolerance, 1);
+    vector<double> truncated3 = holtsmark_kde(samples, queries, h, tolerance, 3);
+
+    double max_error = 0;
+    for (size_t q = 0; q < queries.size(); q++) {
+        max_error = max(max_error, abs(truncated[q] - exact[q]));
+    }
+
+    check(max_error <= tolerance, "truncation error " + to_string(max_error));
+    check(truncated == truncated3, "truncated, 1 vs 3 threads");
+}
+
+// non-finite queries are taken out before sorting, the finite ones are unaffected
+void test_kde_non_finite() {
+    const double nan = numeric_limits<double>::quiet_NaN(), inf = numeric_limits<double>::infinity();
+
+    vector<double> samples = kde_samples(1000, 4);
+    vector<double> finite = { -3, 0, 1, 2.5, 40 };
+    vector<double> queries = { nan, -3, inf, 0, nan, 1, -inf, 2.5, 40, nan };
+
+    for (double tolerance : { 0.0, 1e-8 }) {
+        vector<double> expected = holtsmark_kde(samples, finite, 0.5, tolerance);
+        vector<double> density = holtsmark_kde(samples, queries, 0.5, tolerance);
+
+        string mode = (tolerance > 0) ? "truncated" : "exact";
+
+        check(isnan(density[0]) && isnan(density[4]) && isnan(density[9]), mode + ": nan queries give nan");
+        check(density[2] == 0 && density[6] == 0, mode + ": infinite queries give 0");
+        check(density[1] == expected[0] && density[3] == expected[1] && density[5] == expected[2]
+            && density[7] == expected[3] && density[8] == expected[4], mode + ": finite queries unchanged");
+    }
+
+    vector<double> only_nan = { nan, nan };
+    check(isnan(holtsmark_kde(samples, only_nan, 0.5, 1e-8)[1]), "only nan queries");
+
+    samples[10] = nan;
+    vector<double> density = holtsmark_kde(samples, finite, 0.5, 1e-8);
+    check(all_of(density.begin(), density.end(), [](double d) { return isnan(d); }), "a nan sample gives nan");
+
+    check(holtsmark_kde({}, finite, 0.5)[0] == 0, "no samples");
+}
+
+void test_kde() {
+    test_kde_direct();
+    test_kde_truncated();
+    test_kde_non_finite();
+}
@@ -0,0 +1,129 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_levy_path.hpp"
+
+#include <vector>
+#include <algorithm>
+
+// paths are the prefix sums of their philox streams, for any thread count and storage mode
+void test_levy_path_streams() {
+    levy_path_options options;
+    options.x0 = 1;
+    options.drift = 0.5;
+    options.c = 2;
+    options.dt = 0.125;
+    options.seed = 17;
+
+    const size_t paths = 7, steps = 600;
+
+    levy_path_ensemble e1 = levy_simulate_paths(paths, steps, options, 1);
+    levy_path_ensemble e3 = levy_simulate_paths(paths, steps, options, 3);
+
+    check(e1.values == e3.values && e1.final_values == e3.final_values, "1 vs 3 threads");
+
+    double mu = options.drift * options.dt, c = options.c * pow(options.dt, 2.0 / 3.0);
+
+    bool same = true;
+    for (size_t p = 0; p < paths; p++) {
+        philox_engine engine(options.seed, 2 * steps * p);
+        vector<double> increments(steps);
+
+        for (size_t s0 = 0; s0 < steps; s0 += holtsmark_batch_block) {
+            holtsmark_sample_batch(engine, span<double>(increments).subspan(s0, min(steps - s0, holtsmark_batch_block)), mu, c);
+        }
+
+        double x = options.x0;
+        for (size_t s = 0; s < steps; s++) {
+            x += increments[s];
+            same = same && e1.path(p)[s] == x;
+        }
+        same = same && e1.final_values[p] == x && e1.first_passage[p] == -1;
+    }
+    check(same, "prefix sums of the streams");
+
+    options.store_paths = false;
+    levy_path_ensemble finals = levy_simulate_paths(paths, steps, options, 2);
+
+    check(finals.values.empty() && finals.final_values == e1.final_values, "final values without stored paths");
+}
+
+// first passage is the first step outside (lower, upper), stopped paths stay at the crossing value
+void test_levy_path_barriers() {
+    levy_path_options options;
+    options.lower = -5;
+    options.upper = 8;
+    options.seed = 3;
+
+    const size_t paths = 50, steps = 400;
+
+    levy_path_ensemble free = levy_simulate_paths(paths, steps, options, 2);
+
+    options.stop_at_barrier = true;
+    levy_path_ensemble stopped = levy_simulate_paths(paths, steps, options, 2);
+
+    bool passages = true, stops = true;
+    size_t crossed = 0;
+
+    for (size_t p = 0; p < paths; p++) {
+        span<const double> path = free.path(p);
+
+        auto outside = find_if(path.begin(), path.end(), [&](double x) { return x <= options.lower || x >= options.upper; });
+        int64_t expected = (outside == path.end()) ? -1 : (int64_t)(outside - path.begin());
+
+        passages = passages && free.first_passage[p] == expected && stopped.first_passage[p] == expected;
+
+        if (expected >= 0) {
+            crossed++;
+
+            span<const double> s = stopped.path(p);
+            size_t k = (size_t)expected;
+
+            stops = stops && equal(s.begin(), s.begin() + k + 1, path.begin())
+                && all_of(s.begin() + k, s.end(), [&](double x) { return x == path[k]; })
+                && stopped.final_values[p] == path[k];
+        }
+    }
+
+    check(crossed > 10, "paths cross, " + to_string(crossed));
+    check(passages, "first passage indexes");
+    check(stops, "stopped paths");
+}
+
+// the sum of n steps is holtsmark with location drift T and scale c T^(2/3), T = n dt
+void test_levy_path_stability() {
+    levy_path_options options;
+    options.drift = 0.25;
+    options.c = 1.5;
+    options.dt = 0.01;
+    options.store_paths = false;
+    options.seed = 11;
+
+    const size_t paths = 4000, steps = 100;
+    double t = steps * options.dt;
+
+    levy_path_ensemble e = levy_simulate_paths(paths, steps, options);
+
+    vector<double> x = e.final_values;
+    sort(x.begin(), x.end());
+
+    double d = 0;
+    for (size_t i = 0; i < paths; i++) {
+        double f = holtsmark_cdf((x[i] - options.drift * t) / (options.c * pow(t, 2.0 / 3.0)));
+
+        d = max(d, max(f - (double)i / paths, (double)(i + 1) / paths - f));
+    }
+
+    check(d < 0.03, "ks distance " + to_string(d));
+}
+
+void test_levy_path() {
+    test_levy_path_streams();
+    test_levy_path_barriers();
+    test_levy_path_stability();
+}
@@ -0,0 +1,66 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_likelihood.hpp"
+#include "holtsmark_random.hpp"
+
+// every grid point agrees bit for bit with the scalar entry point, for any thread count,
+// including sizes on and across the chunk boundaries
+void test_likelihood_grid_matches_scalar() {
+    vector<double> mu = { -0.5, 0, 0.25 }, c = { 0.5, 1, 3 };
+
+    for (size_t n : { (size_t)0, (size_t)1, (size_t)1000, holtsmark_likelihood_data_chunk, holtsmark_likelihood_data_chunk * 2 + 17 }) {
+        vector<double> data(n);
+        philox_engine engine(n);
+        holtsmark_sample_batch(engine, data, 0.1, 1.3);
+
+        for (size_t threads : { (size_t)1, (size_t)3 }) {
+            vector<double> grid = holtsmark_loglikelihood_grid(data, mu, c, threads);
+
+            check(grid.size() == mu.size() * c.size(), "grid size");
+
+            for (size_t j = 0; j < mu.size(); j++) {
+                for (size_t k = 0; k < c.size(); k++) {
+                    double expected = holtsmark_loglikelihood(data, mu[j], c[k], 1);
+
+                    check(grid[j * c.size() + k] == expected,
+                        "n = " + to_string(n) + ", threads = " + to_string(threads));
+                }
+            }
+        }
+    }
+}
+
+// the total agrees with a plain sum of logpdf
+void test_likelihood_plain_sum() {
+    vector<double> data(5000);
+    philox_engine engine(3);
+    holtsmark_sample_batch(engine, data);
+
+    double expected = 0;
+    for (double x : data) {
+        expected += holtsmark_logpdf((x - 0.2) / 1.5) - log(1.5);
+    }
+
+    check_near(holtsmark_loglikelihood(data, 0.2, 1.5), expected, 1e-12, "loglikelihood");
+}
+
+// the asymptotic branch beyond 2^128 continues log(pdf)
+void test_logpdf_limit() {
+    double x = 0x1p+128;
+
+    check_near(holtsmark_logpdf(nextafter(x, INFINITY)), holtsmark_logpdf(x), 1e-14, "continuity at 2^128");
+    check_near(holtsmark_logpdf(0x1p+200) - holtsmark_logpdf(0x1p+199), -2.5 * log(2.0), 1e-12, "x^-5/2 tail");
+    check(holtsmark_logpdf(-0x1p+300) == holtsmark_logpdf(0x1p+300), "symmetry");
+}
+
+void test_likelihood() {
+    test_likelihood_grid_matches_scalar();
+    test_likelihood_plain_sum();
+    test_logpdf_limit();
+}
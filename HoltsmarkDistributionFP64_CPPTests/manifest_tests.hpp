@@ -0,0 +1,79 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_distribution.hpp"
+#include "holtsmark_manifest.hpp"
+
+#include <filesystem>
+
+// fnv-1a 64 reference values: the basis for no input, and 8 zero bytes for +0.0
+void test_manifest_hash() {
+    check(hash_values(manifest_hash_basis, {}) == manifest_hash_basis, "empty input");
+
+    uint64_t zeros = manifest_hash_basis;
+    for (int i = 0; i < 8; i++) {
+        zeros = zeros * 0x100000001B3ull;
+    }
+    check(hash_values(manifest_hash_basis, { 0.0 }) == zeros, "+0.0");
+    check(hash_values(manifest_hash_basis, { -0.0 }) != zeros, "-0.0 differs by its sign bit");
+
+    string h = dataset_hash({ -6, 64, 1. / 1024 }, { 1, 2, 3 });
+    check(h.size() == 16 && h == dataset_hash({ -6, 64, 1. / 1024 }, { 1, 2, 3 }), "16 hex digits, deterministic");
+    check(h != dataset_hash({ -6, 64, 1. / 512 }, { 1, 2, 3 }), "grid changes the hash");
+}
+
+// one ulp in any probed segment changes the fingerprint hash
+void test_manifest_fingerprint() {
+    auto pdf = [](double x) { return holtsmark_pdf(x); };
+
+    vector<double> base = fingerprint_x(pdf);
+    check(base == fingerprint_x(pdf), "deterministic");
+
+    string h = dataset_hash({}, base);
+
+    for (double x0 : { 0.1, 1.0, 3.0, 20.0, 1e9 }) {
+        auto perturbed = [x0](double x) {
+            double y = holtsmark_pdf(x);
+            return (x >= x0 && x < x0 * 2) ? nextafter(y, 1.0) : y;
+        };
+
+        check(dataset_hash({}, fingerprint_x(perturbed)) != h, "segment at " + to_string(x0));
+    }
+
+    vector<double> p = fingerprint_p([](double p) { return holtsmark_quantile(p); });
+    check(p.size() == 80 * 32 + 1, "quantile probes");
+}
+
+// manifest round trip and the stale decision
+void test_manifest_file() {
+    filesystem::path dir = filesystem::temp_directory_path() / "holtsmark_manifest_test";
+    filesystem::create_directories(dir);
+
+    string data = (dir / "data.csv").string(), path = (dir / "manifest.csv").string();
+    filesystem::remove(data);
+
+    map<string, string> manifest = { { data, "0123456789abcdef" }, { "other.csv", "fedcba9876543210" } };
+    write_manifest(path, manifest);
+    check(read_manifest(path) == manifest, "round trip");
+
+    check(manifest_stale(manifest, data, "0123456789abcdef"), "missing file is stale");
+
+    ofstream(data) << "x,pdf" << endl;
+    check(!manifest_stale(manifest, data, "0123456789abcdef"), "same hash is up to date");
+    check(manifest_stale(manifest, data, "0123456789abcdee"), "different hash is stale");
+    check(manifest_stale({}, data, "0123456789abcdef"), "no entry is stale");
+    check(read_manifest((dir / "none.csv").string()).empty(), "no manifest");
+
+    filesystem::remove_all(dir);
+}
+
+void test_manifest() {
+    test_manifest_hash();
+    test_manifest_fingerprint();
+    test_manifest_file();
+}
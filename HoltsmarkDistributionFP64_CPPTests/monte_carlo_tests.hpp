@@ -0,0 +1,124 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_monte_carlo.hpp"
+
+#include <vector>
+
+// keeps every value, to compare against the stored sampler
+struct mc_collect {
+    vector<double> values;
+
+    void add(double v) {
+        values.push_back(v);
+    }
+
+    void merge(const mc_collect& other) {
+        values.insert(values.end(), other.values.begin(), other.values.end());
+    }
+
+    void reset() {
+        values.clear();
+    }
+};
+
+// the variates are the philox sequence of holtsmark_sample_batch, in order for one thread
+void test_monte_carlo_sequence() {
+    const size_t n = 3 * holtsmark_mc_chunk + 17;
+
+    mc_collect collected = holtsmark_monte_carlo(n, [](double x) { return x; }, mc_collect(), 1, 2, 9, 1);
+
+    vector<double> expected(n);
+    philox_engine engine(9);
+    holtsmark_sample_batch(engine, expected, 1, 2);
+
+    check(collected.values == expected, "sequence of holtsmark_sample_batch");
+}
+
+// prior contents of init are counted once, integer aggregates do not depend on the thread count
+void test_monte_carlo_init() {
+    const size_t n = 5 * holtsmark_mc_chunk + 123;
+
+    mc_histogram prior(-4, 4, 16);
+    for (int k = 0; k < 100; k++) {
+        prior.add(-5 + 0.1 * k);
+    }
+    uint64_t prior_total = prior.total();
+
+    vector<mc_histogram> results;
+    for (size_t threads : { 1, 2, 3, 8 }) {
+        results.push_back(holtsmark_monte_carlo(n, [](double x) { return x; }, prior, 0, 1, 4, threads));
+    }
+
+    bool same = true;
+    for (const mc_histogram& h : results) {
+        same = same && h.counts == results[0].counts && h.underflow == results[0].underflow && h.overflow == results[0].overflow;
+    }
+    check(same, "histogram with prior counts, 1 to 8 threads");
+    check(results[0].total() == prior_total + n, "prior counted once, total " + to_string(results[0].total()));
+
+    // the histogram without the prior is the difference
+    mc_histogram fresh = holtsmark_monte_carlo(n, [](double x) { return x; }, mc_histogram(-4, 4, 16), 0, 1, 4, 4);
+    bool difference = fresh.underflow + prior.underflow == results[0].underflow;
+    for (size_t k = 0; k < fresh.counts.size(); k++) {
+        difference = difference && fresh.counts[k] + prior.counts[k] == results[0].counts[k];
+    }
+    check(difference, "prior plus fresh");
+
+    mc_moments moments_prior;
+    moments_prior.add(1e6);
+    for (size_t threads : { 1, 4 }) {
+        mc_moments m = holtsmark_monte_carlo(n, [](double x) { return x; }, moments_prior, 0, 1, 4, threads);
+        check(m.count == n + 1 && m.max == 1e6, "moments with prior, threads " + to_string(threads));
+    }
+}
+
+// tail probabilities and moments against the distribution
+void test_monte_carlo_values() {
+    const size_t n = 1 << 20;
+
+    vector<double> thresholds = { -2, 0, 1, 5 };
+    mc_exceedance e = holtsmark_monte_carlo(n, [](double x) { return x; }, mc_exceedance(thresholds), 0, 1, 11);
+
+    check(e.count == n, "exceedance count");
+    for (size_t k = 0; k < thresholds.size(); k++) {
+        double p = holtsmark_cdf(thresholds[k], true);
+        double sigma = sqrt(p * (1 - p) / (double)n);
+
+        check(abs(e.probability(k) - p) < 6 * sigma,
+            "P(X > " + to_string(thresholds[k]) + ") = " + to_string(e.probability(k)) + " vs " + to_string(p));
+    }
+
+    // |X| has infinite variance, the bounded cdf values are uniform
+    mc_moments m = holtsmark_monte_carlo(n, [](double x) { return holtsmark_cdf((x - 3) / 2); }, mc_moments(), 3, 2, 12);
+    check(abs(m.mean - 0.5) < 6 * sqrt(1.0 / 12 / (double)n), "mean of uniform cdf values " + to_string(m.mean));
+    check_near(m.variance(), 1.0 / 12, 1e-2, "variance of uniform cdf values");
+    check(m.min > 0 && m.max < 1, "range of cdf values");
+}
+
+// reset empties but keeps the configuration
+void test_monte_carlo_reset() {
+    mc_histogram h(0, 2, 4);
+    h.add(0.7);
+    h.add(3);
+    h.reset();
+    check(h.total() == 0 && h.counts.size() == 4 && h.lower == 0 && h.upper == 2, "histogram reset");
+
+    vector<double> thresholds = { 1, 2 };
+    mc_exceedance e(thresholds);
+    e.add(3);
+    e.reset();
+    check(e.count == 0 && e.exceedances == vector<uint64_t>{ 0, 0 } && e.thresholds == thresholds, "exceedance reset");
+}
+
+void test_monte_carlo() {
+    test_monte_carlo_sequence();
+    test_monte_carlo_init();
+    test_monte_carlo_values();
+    test_monte_carlo_reset();
+}
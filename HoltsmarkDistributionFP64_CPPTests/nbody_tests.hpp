@@ -0,0 +1,67 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_nbody.hpp"
+
+// the tiled loop against a plain double loop over sources, and independent of the thread count
+void test_nbody_field_direct() {
+    nbody_points sources = nbody_uniform_sphere(3000, 1, 11);
+    nbody_points probes = nbody_uniform_sphere(1500, 0.5, 12);
+
+    nbody_field field = nbody_evaluate_field(sources, probes, 1);
+    nbody_field field3 = nbody_evaluate_field(sources, probes, 3);
+
+    check(field.ex == field3.ex && field.ey == field3.ey && field.ez == field3.ez, "1 vs 3 threads");
+
+    for (size_t p = 0; p < probes.size(); p += 97) {
+        double ex = 0, ey = 0, ez = 0;
+
+        for (size_t s = 0; s < sources.size(); s++) {
+            double dx = probes.x[p] - sources.x[s], dy = probes.y[p] - sources.y[s], dz = probes.z[p] - sources.z[s];
+            double r2 = dx * dx + dy * dy + dz * dz;
+            double w = 1 / (r2 * sqrt(r2));
+
+            ex += dx * w;
+            ey += dy * w;
+            ez += dz * w;
+        }
+
+        check_near(field.ex[p], ex, 1e-13, "ex");
+        check_near(field.ey[p], ey, 1e-13, "ey");
+        check_near(field.ez[p], ez, 1e-13, "ez");
+    }
+}
+
+// the normalized components follow holtsmark(0, 1)
+void test_nbody_holtsmark_fit() {
+    vector<double> v = nbody_normalized_field(1 << 15, 1000, 1, 1.0 / 3, 1);
+
+    check(v.size() == 3000, "3 components per probe");
+    check(nbody_ks_statistic(v) < 0.05, "ks statistic " + to_string(nbody_ks_statistic(v)));
+
+    vector<nbody_histogram_bin> histogram = nbody_histogram(v, -4, 4, 16);
+
+    double probability = 0, expected = 0;
+    for (const nbody_histogram_bin& bin : histogram) {
+        probability += bin.probability;
+        expected += bin.expected_probability;
+    }
+
+    check(histogram.size() == 16, "bins");
+    check(abs(probability - expected) < 0.05, "mass in [-4, 4)");
+}
+
+void test_nbody_histogram_empty() {
+    check(nbody_histogram({}, -1, 1, 8).empty(), "no samples, no bins");
+}
+
+void test_nbody() {
+    test_nbody_field_direct();
+    test_nbody_holtsmark_fit();
+    test_nbody_histogram_empty();
+}
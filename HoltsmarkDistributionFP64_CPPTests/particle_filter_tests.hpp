@@ -0,0 +1,102 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_particle_filter.hpp"
+
+#include <random>
+
+// weights, log-likelihood and systematic resampling against plain loops
+void test_particle_filter_step() {
+    const size_t n = 10000;
+    const double z = 1.5, c = 0.75, u0 = 0.3;
+
+    mt19937_64 engine(5);
+    normal_distribution<double> normal(0, 2);
+
+    vector<double> particles(n);
+    for (double& p : particles) {
+        p = normal(engine);
+    }
+
+    auto h = [](double x) { return x; };
+
+    holtsmark_pf_workspace ws(2);
+    double ll = holtsmark_pf_step(span<const double>(particles), h, z, c, u0, ws);
+
+    vector<double> p(n);
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        p[i] = holtsmark_pdf((z - particles[i]) / c) / c;
+        sum += p[i];
+    }
+
+    check_near(ll, log(sum / n), 1e-12, "log-likelihood increment");
+
+    double weight_sum = 0, max_error = 0;
+    for (size_t i = 0; i < n; i++) {
+        weight_sum += ws.weights[i];
+        max_error = max(max_error, abs(ws.weights[i] - p[i] / sum) / (p[i] / sum));
+    }
+    check_near(weight_sum, 1, 1e-12, "weights sum to 1");
+    check(max_error < 1e-12, "normalized weights");
+
+    // naive systematic resampling
+    size_t mismatches = 0, i = 0;
+    double cumulative = ws.weights[0];
+    for (size_t j = 0; j < n; j++) {
+        double position = (u0 + j) / n;
+
+        while (i < n - 1 && cumulative <= position) {
+            cumulative += ws.weights[++i];
+        }
+
+        mismatches += (ws.ancestors[j] != i) ? 1 : 0;
+    }
+    // rounding of the two cumulative sums may move an ancestor by one at a boundary
+    check(mismatches <= 2, "systematic resampling, mismatches " + to_string(mismatches));
+}
+
+// the step does not depend on the thread count
+void test_particle_filter_threads() {
+    const size_t n = 20000;
+
+    vector<double> particles(n);
+    for (size_t i = 0; i < n; i++) {
+        particles[i] = sin((double)i) * 10;
+    }
+
+    auto h = [](double x) { return x * x / 4; };
+
+    holtsmark_pf_workspace ws1(1), ws3(3);
+    double ll1 = holtsmark_pf_step(span<const double>(particles), h, 2.0, 1.0, 0.5, ws1);
+    double ll3 = holtsmark_pf_step(span<const double>(particles), h, 2.0, 1.0, 0.5, ws3);
+
+    check(ll1 == ll3, "log-likelihood, 1 vs 3 threads");
+    check(ws1.weights == ws3.weights, "weights, 1 vs 3 threads");
+    check(ws1.ancestors == ws3.ancestors, "ancestors, 1 vs 3 threads");
+}
+
+void test_particle_filter_degenerate() {
+    holtsmark_pf_workspace ws(1);
+    auto h = [](double x) { return x; };
+
+    vector<double> none;
+    check(holtsmark_pf_step(span<const double>(none), h, 0.0, 1.0, 0.5, ws) == -numeric_limits<double>::infinity(), "no particles");
+
+    // one particle carries all the weight
+    vector<double> one = { 3 };
+    double ll = holtsmark_pf_step(span<const double>(one), h, 1.0, 2.0, 0.5, ws);
+    check_near(ll, log(holtsmark_pdf(-1.0) / 2), 1e-15, "single particle");
+    check(ws.weights[0] == 1 && ws.ancestors[0] == 0, "single particle weight");
+}
+
+void test_particle_filter() {
+    test_particle_filter_step();
+    test_particle_filter_threads();
+    test_particle_filter_degenerate();
+}
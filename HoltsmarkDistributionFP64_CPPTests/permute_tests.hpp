@@ -0,0 +1,49 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_permute.hpp"
+#include "bucketed_tests.hpp"
+
+// pdf and cdf bit-identical to the plain batch kernels, the tail lengths cover the scalar
+// remainder after the 8 lane loop when built with AVX-512
+void test_permute_identical() {
+    for (size_t n : { 1, 7, 8, 9, 64, 1001, 5000 }) {
+        vector<double> x = segment_mixed_inputs(n, n + 1), y(n), expected(n);
+
+        for (auto [mu, c] : { pair{ 0.0, 1.0 }, pair{ 0.75, 3.0 }, pair{ -2.0, 0.125 } }) {
+            string tag = " n=" + to_string(n) + " mu=" + to_string(mu) + " c=" + to_string(c);
+
+            holtsmark_pdf_permute_batch(x, y, mu, c);
+            holtsmark_pdf_batch(x, expected, mu, c);
+            check(y == expected, "pdf" + tag);
+
+            for (bool complementary : { false, true }) {
+                holtsmark_cdf_permute_batch(x, y, mu, c, complementary);
+                holtsmark_cdf_batch(x, expected, mu, c, complementary);
+                check(y == expected, string(complementary ? "ccdf" : "cdf") + tag);
+            }
+        }
+    }
+}
+
+// the transposed table holds the segment coefficients
+void test_permute_table() {
+    const transposed_pade_table& table = holtsmark_pdf_transposed_table();
+
+    bool same = true;
+    for (double x : segment_mixed_inputs(2000, 5)) {
+        same = same && holtsmark_pdf_permute(table, x) == holtsmark_pdf(x);
+        same = same && holtsmark_cdf_permute(holtsmark_cdf_transposed_table(), x, true) == holtsmark_cdf(x, true);
+    }
+    check(same, "scalar lookups");
+}
+
+void test_permute() {
+    test_permute_identical();
+    test_permute_table();
+}
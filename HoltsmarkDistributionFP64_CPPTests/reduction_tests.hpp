@@ -0,0 +1,111 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include <atomic>
+#include "holtsmark_test.hpp"
+#include "holtsmark_reduction.hpp"
+#include "holtsmark_batch.hpp"
+#include "holtsmark_random.hpp"
+
+vector<double> reduction_test_values(size_t n) {
+    vector<double> values(n);
+    philox_engine engine(n);
+    holtsmark_sample_batch(engine, values);
+
+    return values;
+}
+
+// bit-identical for any thread count, through both parallel loops
+void test_reduction_thread_independent() {
+    for (size_t n : { (size_t)0, (size_t)1, (size_t)1023, (size_t)65536, (size_t)200003 }) {
+        vector<double> values = reduction_test_values(n);
+
+        double expected = reproducible_sum(values, 1);
+
+        for (size_t threads : { (size_t)2, (size_t)3, (size_t)7 }) {
+            check(reproducible_sum(values, threads) == expected, "n = " + to_string(n) + ", threads = " + to_string(threads));
+        }
+
+        parallel_pool pool(3);
+        vector<double> task_sums(reproducible_sum_tasks(n));
+        double pooled = reproducible_sum(n, [&](size_t i0, span<double> buffer) {
+            copy_n(values.begin() + i0, buffer.size(), buffer.begin());
+        }, span<double>(task_sums), pool);
+
+        check(pooled == expected, "pool, n = " + to_string(n));
+    }
+}
+
+// the fixed tree stays close to an extended precision sum
+void test_reduction_accuracy() {
+    vector<double> values = reduction_test_values(300000);
+
+    long double exact = 0, magnitude = 0;
+    for (double v : values) {
+        exact += v;
+        magnitude += abs(v);
+    }
+
+    check(abs((long double)reproducible_sum(values) - exact) <= 1e-14L * magnitude, "pairwise error");
+}
+
+// every component of the vector sum follows the scalar tree
+void test_reduction_vector() {
+    vector<double> values = reduction_test_values(100000);
+
+    vector<double> sums = reproducible_sum_vector(values.size(), 2, [&](size_t i, span<double> acc) {
+        acc[0] = values[i];
+        acc[1] = values[i] * values[i];
+    }, 3);
+
+    vector<double> squares(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        squares[i] = values[i] * values[i];
+    }
+
+    check(sums[0] == reproducible_sum(values, 1), "component 0");
+    check(sums[1] == reproducible_sum(squares, 1), "component 1");
+}
+
+void test_reduction_pdf_sum() {
+    vector<double> values = reduction_test_values(50000);
+
+    check(holtsmark_pdf_sum(values, 0.5, 2, 1) == holtsmark_pdf_sum(values, 0.5, 2, 4), "pdf sum, 1 vs 4 threads");
+}
+
+// every task runs exactly once, also when the pool is reused
+void test_parallel_loops() {
+    parallel_pool pool(4);
+
+    for (size_t tasks : { (size_t)0, (size_t)1, (size_t)5, (size_t)1000 }) {
+        vector<atomic<int>> visits(tasks), pooled(tasks);
+
+        parallel_for(tasks, [&](size_t i) { visits[i]++; }, 3);
+        for (int repeat = 0; repeat < 3; repeat++) {
+            parallel_for(tasks, [&](size_t i) { pooled[i]++; }, pool);
+        }
+
+        bool once = true, thrice = true;
+        for (size_t i = 0; i < tasks; i++) {
+            once &= visits[i] == 1;
+            thrice &= pooled[i] == 3;
+        }
+
+        check(once, "parallel_for, tasks = " + to_string(tasks));
+        check(thrice, "parallel_pool, tasks = " + to_string(tasks));
+    }
+
+    check(pool.threads() == 4, "pool threads");
+}
+
+void test_reduction() {
+    test_reduction_thread_independent();
+    test_reduction_accuracy();
+    test_reduction_vector();
+    test_reduction_pdf_sum();
+    test_parallel_loops();
+}
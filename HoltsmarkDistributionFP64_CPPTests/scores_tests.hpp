@@ -0,0 +1,107 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_scores.hpp"
+
+#include <vector>
+#include <limits>
+
+// P(Z > z) equals P(X > x) on the upper side, and the lower side by symmetry
+void test_scores_probabilities() {
+    vector<double> x, z;
+    for (double v = -60; v <= 60; v += 0.173) {
+        x.push_back(v);
+    }
+    z.resize(x.size());
+
+    holtsmark_to_normal_scores(x, z);
+
+    double max_error = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        double a = abs(x[i]), b = abs(z[i]);
+
+        // the smaller of the central half mass and the tail keeps full relative precision
+        double expected = (a < 0.5) ? holtsmark_cdf(a) - 0.5 : holtsmark_cdf(a, true);
+        double actual = (a < 0.5) ? erf(b / sqrt2) / 2 : erfc(b / sqrt2) / 2;
+
+        max_error = max(max_error, (expected == 0) ? abs(actual) : abs(actual - expected) / expected);
+    }
+
+    check(max_error < 1e-13, "probabilities match, max rel. error " + to_string(max_error));
+}
+
+// x -> z -> x over the whole range, including |x| > 2^128 where the log tail is used
+void test_scores_round_trip() {
+    vector<double> x;
+    for (double a = 1e-12; a < 1e306; a *= 3.7) {
+        x.push_back(a);
+        x.push_back(-a);
+    }
+    x.push_back(0);
+
+    for (auto [mu, c] : { pair{ 0.0, 1.0 }, pair{ 2.0, 0.5 } }) {
+        vector<double> xs(x.size()), z(x.size()), back(x.size());
+        for (size_t i = 0; i < x.size(); i++) {
+            xs[i] = mu + c * x[i];
+        }
+
+        holtsmark_to_normal_scores(xs, z, mu, c);
+        normal_scores_to_holtsmark(z, back, mu, c);
+
+        double max_error = 0;
+        bool finite = true;
+        for (size_t i = 0; i < x.size(); i++) {
+            finite = finite && isfinite(z[i]);
+
+            // the location shift rounds the standardized value for small |x|
+            double scale = max(abs(xs[i] - mu), abs(mu) * 1e-3 + 1e-300);
+            max_error = max(max_error, abs(back[i] - xs[i]) / scale);
+        }
+
+        string tag = " mu=" + to_string(mu) + " c=" + to_string(c);
+        check(finite, "finite scores" + tag);
+        check(max_error < 1e-11, "round trip" + tag + ", max rel. error " + to_string(max_error));
+    }
+
+    // the scores keep growing beyond 2^128
+    vector<double> far = { 0x1p+127, 0x1p+128, 0x1p+129, 1e200, 1e300, 1.7e308 }, z(far.size());
+    holtsmark_to_normal_scores(far, z);
+
+    bool increasing = true;
+    for (size_t i = 1; i < z.size(); i++) {
+        increasing = increasing && z[i] > z[i - 1];
+    }
+    check(increasing, "monotone beyond 2^128");
+}
+
+// infinities map to infinities both ways, nan stays nan
+void test_scores_non_finite() {
+    const double inf = numeric_limits<double>::infinity();
+
+    vector<double> x = { inf, -inf, numeric_limits<double>::quiet_NaN() }, z(3), back(3);
+
+    holtsmark_to_normal_scores(x, z);
+    check(z[0] == inf && z[1] == -inf, "x = +-inf gives z = +-inf");
+    check(isnan(z[2]), "nan");
+
+    normal_scores_to_holtsmark(z, back);
+    check(back[0] == inf && back[1] == -inf, "z = +-inf gives x = +-inf");
+
+    check(normal_quantile_upper_log(-inf) == inf, "log tail of zero");
+
+    // finite inputs that overflow when standardized
+    vector<double> big = { 1e308, -1e308 }, zb(2);
+    holtsmark_to_normal_scores(big, zb, 0, 1e-10);
+    check(zb[0] == inf && zb[1] == -inf, "standardized overflow");
+}
+
+void test_scores() {
+    test_scores_probabilities();
+    test_scores_round_trip();
+    test_scores_non_finite();
+}
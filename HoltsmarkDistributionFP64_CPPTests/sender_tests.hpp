@@ -0,0 +1,138 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_sender.hpp"
+
+#include <random>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+
+namespace exec = holtsmark::exec;
+
+vector<double> sender_inputs(size_t n) {
+    vector<double> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = -50 + 100 * (double)i / (double)n;
+    }
+    return x;
+}
+
+// the senders give the batch results on either scheduler
+void test_sender_values() {
+    vector<double> x = sender_inputs(3000), y(x.size()), expected(x.size());
+
+    exec::thread_pool pool(2);
+
+    optional<span<double>> r = exec::sync_wait(exec::pdf(exec::inline_scheduler(), x, y, 1, 2));
+    holtsmark_pdf_batch(x, expected, 1, 2);
+    check(r.has_value() && r->data() == y.data() && y == expected, "pdf inline");
+
+    r = exec::sync_wait(exec::cdf(pool.get_scheduler(), x, y, 0, 1, true));
+    holtsmark_cdf_batch(x, expected, 0, 1, true);
+    check(r.has_value() && y == expected, "ccdf on the pool");
+
+    vector<double> p = { 0.001, 0.3, 0.5, 0.9 }, q(p.size()), q_expected(p.size());
+    exec::sync_wait(exec::quantile(pool.get_scheduler(), p, q));
+    holtsmark_quantile_batch(p, q_expected);
+    check(q == q_expected, "quantile on the pool");
+
+    // the sample sender draws block by block from the engine
+    mt19937_64 engine(4), reference(4);
+    vector<double> s(3000), s_expected(3000);
+    exec::sync_wait(exec::sample(pool.get_scheduler(), engine, s, 1, 2));
+    for (size_t i0 = 0; i0 < s.size(); i0 += holtsmark_batch_block) {
+        holtsmark_sample_batch(reference, span<double>(s_expected).subspan(i0, min(s.size() - i0, holtsmark_batch_block)), 1, 2);
+    }
+    check(s == s_expected, "sample on the pool");
+}
+
+// then runs on the context of the predecessor, and its errors reach the waiter
+void test_sender_then() {
+    vector<double> x = sender_inputs(100), y(x.size());
+
+    exec::thread_pool pool(1);
+
+    auto sum_on_pool = exec::then(exec::pdf(pool.get_scheduler(), x, y), [](span<double> v) {
+        return pair{ accumulate(v.begin(), v.end(), 0.0), this_thread::get_id() };
+    });
+
+    optional<pair<double, thread::id>> r = exec::sync_wait(sum_on_pool);
+
+    double expected = 0;
+    for (double v : x) {
+        expected += holtsmark_pdf(v);
+    }
+
+    check(r.has_value() && r->first == expected, "sum of the pdf");
+    check(r.has_value() && r->second != this_thread::get_id(), "then ran on the pool");
+
+    auto failing = exec::then(exec::pdf(exec::inline_scheduler(), x, y), [](span<double>) -> int {
+        throw runtime_error("then failed");
+    });
+
+    bool thrown = false;
+    try {
+        exec::sync_wait(failing);
+    }
+    catch (const runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "error rethrown by sync_wait");
+}
+
+// a stop requested before the run completes with set_stopped, nothing is written
+void test_sender_stop() {
+    vector<double> x = sender_inputs(5000), y(x.size(), -1.0);
+
+    stop_source source;
+    source.request_stop();
+
+    optional<span<double>> r = exec::sync_wait(exec::pdf(exec::inline_scheduler(), x, y), &source);
+    check(!r.has_value(), "stopped");
+    check(all_of(y.begin(), y.end(), [](double v) { return v == -1.0; }), "nothing written");
+
+    // the stop token passes through then
+    optional<double> t = exec::sync_wait(exec::then(exec::pdf(exec::inline_scheduler(), x, y), [](span<double> v) { return v[0]; }), &source);
+    check(!t.has_value(), "stopped through then");
+}
+
+// many operations in flight on one pool
+void test_sender_concurrent() {
+    exec::thread_pool pool(3);
+
+    const size_t tasks = 16;
+    vector<vector<double>> x(tasks), y(tasks);
+    vector<thread> waiters;
+    vector<int> ok(tasks, 0);
+
+    for (size_t t = 0; t < tasks; t++) {
+        x[t] = sender_inputs(500 + 100 * t);
+        y[t].resize(x[t].size());
+
+        waiters.emplace_back([&, t]() {
+            vector<double> expected(x[t].size());
+            holtsmark_cdf_batch(x[t], expected, (double)t, 1);
+
+            ok[t] = exec::sync_wait(exec::cdf(pool.get_scheduler(), x[t], y[t], (double)t, 1)).has_value() && y[t] == expected;
+        });
+    }
+
+    for (thread& w : waiters) {
+        w.join();
+    }
+
+    check(all_of(ok.begin(), ok.end(), [](int v) { return v != 0; }), "16 concurrent operations");
+}
+
+void test_sender() {
+    test_sender_values();
+    test_sender_then();
+    test_sender_stop();
+    test_sender_concurrent();
+}
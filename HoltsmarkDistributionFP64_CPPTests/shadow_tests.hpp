@@ -0,0 +1,217 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_shadow.hpp"
+
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <sstream>
+
+// waits until the background thread has evaluated every accepted sample
+holtsmark_shadow_report shadow_settled_report(const holtsmark_shadow_telemetry& telemetry) {
+    for (int attempt = 0; attempt < 5000; attempt++) {
+        holtsmark_shadow_report r = telemetry.report();
+
+        uint64_t evaluated = 0;
+        for (const holtsmark_shadow_segment_stats& s : r.pdf_segments) {
+            evaluated += s.count;
+        }
+        for (const holtsmark_shadow_segment_stats& s : r.cdf_segments) {
+            evaluated += s.count;
+        }
+
+        if (evaluated == r.sampled) {
+            return r;
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    return telemetry.report();
+}
+
+// error-free products and the double-double reference against the double kernels
+void test_shadow_double_double() {
+    double a = 1 + 0x1p-30;
+    double_double p = dd_mul({ a, 0 }, { a, 0 });
+    check(p.hi == 1 + 0x1p-29 && p.lo == 0x1p-60, "exact square of 1 + 2^-30");
+
+    double_double third = dd_div({ 1, 0 }, { 3, 0 });
+    double_double one = dd_mul(third, { 3, 0 });
+    check(abs((one.hi - 1) + one.lo) < 1e-30, "(1 / 3) * 3");
+
+    double_double root = dd_sqrt({ 2, 0 });
+    double_double two = dd_mul(root, root);
+    check(abs((two.hi - 2) + two.lo) < 1e-30, "sqrt(2)^2");
+
+    // the double evaluation is within a few ulp of the same approximation in double-double
+    double max_pdf = 0, max_cdf = 0;
+    for (double x = -200; x <= 200; x += 0.0137) {
+        double_double rp = holtsmark_pdf_shadow(x), rc = holtsmark_cdf_shadow(x), rq = holtsmark_cdf_shadow(x, true);
+
+        max_pdf = max(max_pdf, abs(holtsmark_pdf(x) - rp.hi) / rp.hi);
+        max_cdf = max(max_cdf, abs(holtsmark_cdf(x) - rc.hi) / rc.hi);
+        max_cdf = max(max_cdf, abs(holtsmark_cdf(x, true) - rq.hi) / rq.hi);
+    }
+    for (double x = 200; x < 1e300; x *= 1.9) {
+        double_double rp = holtsmark_pdf_shadow(x), rq = holtsmark_cdf_shadow(x, true);
+
+        max_pdf = max(max_pdf, abs(holtsmark_pdf(x) - rp.hi) / rp.hi);
+        max_cdf = max(max_cdf, abs(holtsmark_cdf(x, true) - rq.hi) / rq.hi);
+    }
+
+    check(max_pdf < 1e-14, "pdf against its shadow, max rel. error " + to_string(max_pdf));
+    check(max_cdf < 1e-14, "cdf against its shadow, max rel. error " + to_string(max_cdf));
+}
+
+// fifo, full and empty, and every value of concurrent producers arrives once
+void test_shadow_queue() {
+    mpsc_queue<int> q(3);
+
+    bool pushed = true;
+    for (int k = 0; k < 4; k++) {
+        pushed = pushed && q.push(k);
+    }
+    check(pushed && !q.push(4), "capacity rounded up to 4, then full");
+
+    int v = -1;
+    bool fifo = true;
+    for (int k = 0; k < 4; k++) {
+        fifo = fifo && q.pop(v) && v == k;
+    }
+    check(fifo && !q.pop(v), "fifo, then empty");
+
+    const int producers = 4, per_producer = 20000;
+    mpsc_queue<int> shared(256);
+    vector<int> seen(producers * per_producer, 0);
+
+    vector<thread> threads;
+    for (int t = 0; t < producers; t++) {
+        threads.emplace_back([&, t]() {
+            for (int k = 0; k < per_producer; k++) {
+                while (!shared.push(t * per_producer + k)) {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int received = 0;
+    while (received < producers * per_producer) {
+        if (shared.pop(v)) {
+            seen[v]++;
+            received++;
+        }
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+
+    check(all_of(seen.begin(), seen.end(), [](int n) { return n == 1; }), "every value once from 4 producers");
+}
+
+// with period 1 every call is sampled and counted in the segment of its argument
+void test_shadow_counts() {
+    holtsmark_shadow_telemetry telemetry(1, 8, 1 << 16);
+
+    vector<size_t> pdf_expected(holtsmark_pdf_limit_index + 1, 0), cdf_expected(holtsmark_cdf_limit_index + 1, 0);
+
+    bool same = true;
+    size_t calls = 0;
+    for (double x = -60; x <= 60; x += 0.25) {
+        same = same && telemetry.pdf(x) == holtsmark_pdf(x) && telemetry.cdf(x, x > 0) == holtsmark_cdf(x, x > 0);
+
+        pdf_expected[holtsmark_pdf_segment_index(x)]++;
+        cdf_expected[holtsmark_cdf_segment_index(x)]++;
+        calls += 2;
+    }
+    check(same, "scalar results unchanged");
+
+    // batch elements are standardized before they are sampled
+    vector<double> x(1000), y(x.size()), y_expected(x.size());
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = 1 + 2 * (-50 + 0.1 * (double)i);
+        pdf_expected[holtsmark_pdf_segment_index((x[i] - 1) * 0.5)]++;
+    }
+    telemetry.pdf_batch(x, y, 1, 2);
+    holtsmark_pdf_batch(x, y_expected, 1, 2);
+    check(y == y_expected, "batch results unchanged");
+    calls += x.size();
+
+    holtsmark_shadow_report r = shadow_settled_report(telemetry);
+
+    check(r.sampled == calls && r.dropped == 0, "every call sampled, " + to_string(r.sampled) + " of " + to_string(calls));
+
+    bool segments = true;
+    double max_error = 0;
+    for (size_t k = 0; k < pdf_expected.size(); k++) {
+        segments = segments && r.pdf_segments[k].count == pdf_expected[k];
+        max_error = max(max_error, r.pdf_segments[k].max_relative_error);
+    }
+    for (size_t k = 0; k < cdf_expected.size(); k++) {
+        segments = segments && r.cdf_segments[k].count == cdf_expected[k];
+        max_error = max(max_error, r.cdf_segments[k].max_relative_error);
+    }
+    check(segments, "counts per segment");
+    check(max_error < 1e-14, "rounding errors, max " + to_string(max_error));
+
+    // the worst list is bounded, descending and free of repeats
+    bool worst = r.worst.size() == 8;
+    for (size_t i = 1; i < r.worst.size(); i++) {
+        worst = worst && r.worst[i - 1].relative_error >= r.worst[i].relative_error;
+        for (size_t j = 0; j < i; j++) {
+            worst = worst && !(r.worst[i].kind == r.worst[j].kind && r.worst[i].x == r.worst[j].x);
+        }
+    }
+    check(worst, "worst inputs");
+
+    ostringstream csv;
+    telemetry.write_worst(csv);
+    string text = csv.str();
+    check((size_t)count(text.begin(), text.end(), '\n') == r.worst.size() + 1, "csv rows");
+}
+
+// the sampled fraction follows the period, and instances on one thread do not share countdowns
+void test_shadow_period() {
+    const size_t calls = 200000;
+
+    holtsmark_shadow_telemetry rare(100, 4, 1 << 14), never(1ull << 60, 4), always(1, 4, 1 << 18);
+
+    for (size_t i = 0; i < calls; i++) {
+        double x = (double)(i % 2000) * 0.01;
+
+        rare.pdf(x);
+        never.cdf(x);
+        always.cdf(x, true);
+    }
+
+    holtsmark_shadow_report r = shadow_settled_report(rare);
+    uint64_t total = r.sampled + r.dropped;
+    check(total > calls / 100 * 9 / 10 && total < calls / 100 * 11 / 10, "period 100, sampled " + to_string(total));
+
+    check(never.report().sampled + never.report().dropped == 0, "period 2^60 samples nothing");
+
+    holtsmark_shadow_report ra = always.report();
+    check(ra.sampled + ra.dropped == calls, "period 1 next to other instances");
+
+    // a full queue drops instead of blocking, every sample is accounted for
+    holtsmark_shadow_telemetry small(1, 4, 2);
+    vector<double> x(50000, 0.5), y(x.size());
+    small.cdf_batch(x, y);
+
+    holtsmark_shadow_report rs = small.report();
+    check(rs.sampled + rs.dropped == x.size(), "sampled plus dropped");
+}
+
+void test_shadow() {
+    test_shadow_double_double();
+    test_shadow_queue();
+    test_shadow_counts();
+    test_shadow_period();
+}
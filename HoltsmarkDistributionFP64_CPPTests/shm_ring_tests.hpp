@@ -0,0 +1,133 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_shm_ring.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <thread>
+#include <vector>
+#include <string>
+#include <random>
+
+// several client threads share a small ring, every result matches the scalar functions
+void test_shm_ring_handoff() {
+    const string name = "/holtsmark_shm_ring_test";
+
+    holtsmark_shm_worker worker(name, 4, 256);
+    thread server([&]() { worker.run(); });
+
+    const size_t clients = 3, rounds = 200;
+    vector<size_t> mismatches(clients, 0);
+    vector<thread> threads;
+
+    for (size_t t = 0; t < clients; t++) {
+        threads.emplace_back([&, t]() {
+            holtsmark_shm_client client(name);
+            mt19937_64 engine(t);
+            uniform_real_distribution<double> uniform(-20, 20);
+
+            for (size_t r = 0; r < rounds; r++) {
+                vector<double> x(1 + r % 256), y(x.size());
+                for (double& v : x) {
+                    v = uniform(engine);
+                }
+
+                holtsmark_daemon_op op = (r % 2 == 0) ? holtsmark_daemon_pdf : holtsmark_daemon_cdf;
+
+                if (!client.evaluate(op, x, y, 0.5, 2)) {
+                    mismatches[t]++;
+                    continue;
+                }
+
+                for (size_t i = 0; i < x.size(); i++) {
+                    double z = (x[i] - 0.5) / 2;
+                    double expected = (op == holtsmark_daemon_pdf) ? holtsmark_pdf(z) / 2 : holtsmark_cdf(z, false);
+
+                    mismatches[t] += (abs(y[i] - expected) > 1e-15 * abs(expected)) ? 1 : 0;
+                }
+            }
+        });
+    }
+
+    for (thread& t : threads) {
+        t.join();
+    }
+
+    for (size_t t = 0; t < clients; t++) {
+        check(mismatches[t] == 0, "client " + to_string(t) + " mismatches " + to_string(mismatches[t]));
+    }
+
+    worker.stop();
+    server.join();
+}
+
+// sampling is seeded per request, bad parameters and oversized batches are refused
+void test_shm_ring_requests() {
+    const string name = "/holtsmark_shm_ring_requests_test";
+
+    holtsmark_shm_worker worker(name, 2, 64);
+    thread server([&]() { worker.run(); });
+
+    holtsmark_shm_client client(name);
+    check(client.capacity() == 64, "capacity");
+
+    vector<double> y(64), expected(64);
+    mt19937_64 engine(7);
+    holtsmark_sample_batch(engine, expected, 1, 3);
+
+    check(client.evaluate(holtsmark_daemon_sample, {}, y, 1, 3, false, 7) && y == expected, "seeded sample");
+
+    vector<double> x(64, 1.0), too_many(65, 1.0), z(65);
+    check(!client.evaluate(holtsmark_daemon_pdf, x, y, 0, -1), "c <= 0 refused");
+    check(!client.evaluate(holtsmark_daemon_pdf, too_many, z), "oversized batch refused");
+    check(client.evaluate(holtsmark_daemon_pdf, x, y) && y[0] == holtsmark_pdf(1), "ring still serves");
+
+    worker.stop();
+    server.join();
+}
+
+// an idle worker sleeps on the futex instead of yielding in a loop, a request wakes it
+void test_shm_ring_idle_sleep() {
+    const string name = "/holtsmark_shm_ring_idle_test";
+
+    holtsmark_shm_worker worker(name, 2, 16);
+    worker.spin_limit = 64;
+    thread server([&]() { worker.run(); });
+
+    bool asleep = false;
+    for (int i = 0; i < 200 && !asleep; i++) {
+        this_thread::sleep_for(chrono::milliseconds(5));
+        asleep = worker.header().worker_sleeping.load() != 0;
+    }
+    check(asleep, "idle worker sleeps");
+
+    holtsmark_shm_client client(name);
+
+    for (int round = 0; round < 20; round++) {
+        vector<double> x = { (double)round }, y(1);
+
+        check(client.evaluate(holtsmark_daemon_cdf, x, y) && y[0] == holtsmark_cdf(round, false), "woken for round " + to_string(round));
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+
+    worker.stop();
+    server.join();
+}
+
+void test_shm_ring() {
+    test_shm_ring_handoff();
+    test_shm_ring_requests();
+    test_shm_ring_idle_sleep();
+}
+
+#else
+
+void test_shm_ring() {}
+
+#endif
@@ -0,0 +1,86 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_distribution.hpp"
+
+#include <limits>
+
+// ulps between two positive finite doubles
+double ulp_distance(double a, double b) {
+    return abs(a - b) / (nextafter(b, numeric_limits<double>::infinity()) - b);
+}
+
+// x = k^3 2^3j gives x^-2/3 = 2^-2j / k^2, a correctly rounded reference in plain double
+void test_tail_transform_pow_m2d3() {
+    double max_ulps = 0;
+
+    for (int j = -330; j <= 330; j += 11) {
+        for (double k = 1; k < 100000; k = floor(k * 1.37) + 1) {
+            double x = ldexp(k * k * k, 3 * j);
+            double expected = ldexp(1 / (k * k), -2 * j);
+
+            if (!isfinite(x) || x < numeric_limits<double>::min()) {
+                continue;
+            }
+
+            max_ulps = max(max_ulps, ulp_distance(pow_m2d3(x), expected));
+            max_ulps = max(max_ulps, ulp_distance(pow_m2d3(-x), expected));
+        }
+    }
+
+    check(max_ulps <= 2, "pow_m2d3 within 2 ulp, max " + to_string(max_ulps));
+
+    const double inf = numeric_limits<double>::infinity(), tiny = numeric_limits<double>::denorm_min();
+
+    check(pow_m2d3(0) == inf && pow_m2d3(-0.0) == inf, "zero");
+    check(pow_m2d3(inf) == 0 && pow_m2d3(-inf) == 0, "infinity");
+    check(isnan(pow_m2d3(numeric_limits<double>::quiet_NaN())), "nan");
+    check_near(pow_m2d3(0x1p-1068), 0x1p+712, 4.5e-16, "subnormal");
+    check(isfinite(pow_m2d3(tiny)) && pow_m2d3(tiny) > 0x1p+715, "smallest subnormal");
+}
+
+void test_tail_transform_powers() {
+    double max_ulps = 0;
+
+    for (int e = -500; e <= 500; e += 2) {
+        for (double m : { 1.0, 1.25, 1.75 }) {
+            // x = m^2 4^e, x^-1/2 = m^-1 2^-e
+            double x = ldexp(m * m, 2 * e), s = ldexp(1 / m, -e);
+
+            max_ulps = max(max_ulps, ulp_distance(pow_m1p5(x), s * s * s));
+            if (abs(e) < 200) {
+                max_ulps = max(max_ulps, ulp_distance(pow_m2p5(x), s * s * s * s * s));
+            }
+        }
+    }
+
+    check(max_ulps <= 4, "pow_m1p5 and pow_m2p5 within 4 ulp, max " + to_string(max_ulps));
+}
+
+// the limit branches follow the leading tail terms, and quantile inverts the tail cdf
+void test_tail_transform_limits() {
+    const double pdf_limit = 0.75 / sqrt(2 * pi), ccdf_limit = 0.5 / sqrt(2 * pi);
+
+    for (int k : { 80, 200, 400 }) {
+        double x = ldexp(1, k);
+
+        check_near(holtsmark_pdf(x) * pow(x, 2.5), pdf_limit, 1e-14, "pdf tail at 2^" + to_string(k));
+        check_near(holtsmark_cdf(x, true) * pow(x, 1.5), ccdf_limit, 1e-14, "ccdf tail at 2^" + to_string(k));
+    }
+
+    for (double x : { 70.0, 1e3, 1e6, 1e20, 1e100 }) {
+        check_near(holtsmark_quantile(holtsmark_cdf(x, true), true), x, 1e-14, "quantile of ccdf at " + to_string(x));
+        check_near(holtsmark_quantile(holtsmark_cdf(-x)), -x, 1e-14, "quantile of cdf at " + to_string(-x));
+    }
+}
+
+void test_tail_transform() {
+    test_tail_transform_pow_m2d3();
+    test_tail_transform_powers();
+    test_tail_transform_limits();
+}
@@ -0,0 +1,117 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_variate_service.hpp"
+
+#include <ctime>
+#include <chrono>
+#include <vector>
+#include <stdexcept>
+
+// the first n variates of consumer k: blocks of the philox stream (seed, k << 48)
+vector<double> variate_service_expected(uint64_t seed, uint64_t k, size_t n, double mu, double c) {
+    philox_engine engine(seed, k << 48);
+
+    size_t blocks = (n + holtsmark_variate_block_size - 1) / holtsmark_variate_block_size;
+    vector<double> x(blocks * holtsmark_variate_block_size);
+
+    for (size_t b = 0; b < blocks; b++) {
+        holtsmark_sample_batch(engine, span<double>(x).subspan(b * holtsmark_variate_block_size, holtsmark_variate_block_size), mu, c);
+    }
+
+    x.resize(n);
+
+    return x;
+}
+
+// every consumer draws its own stream, whatever the producer count and the timing
+void test_variate_service_streams() {
+    const size_t consumers = 3, n = 20000;
+
+    for (size_t producers : { 1, 2, 3 }) {
+        holtsmark_variate_service service(consumers, 1, 2, 5, 2, producers);
+
+        vector<vector<double>> drawn(consumers, vector<double>(n));
+        vector<thread> threads;
+
+        for (size_t k = 0; k < consumers; k++) {
+            threads.emplace_back([&, k]() {
+                holtsmark_variate_service::consumer& consumer = service[k];
+
+                // mixed single draws and spans across block boundaries
+                size_t i = 0;
+                while (i < n) {
+                    if (i % 3 == 0) {
+                        drawn[k][i++] = consumer.next();
+                    }
+                    else {
+                        size_t len = min(n - i, (size_t)777);
+                        consumer.fill(span<double>(drawn[k]).subspan(i, len));
+                        i += len;
+                    }
+                }
+            });
+        }
+
+        for (thread& t : threads) {
+            t.join();
+        }
+
+        for (size_t k = 0; k < consumers; k++) {
+            check(drawn[k] == variate_service_expected(5, k, n, 1, 2),
+                "consumer " + to_string(k) + " with " + to_string(producers) + " producers");
+        }
+    }
+}
+
+// a consumer with one block keeps waiting for the producer, and still gets its stream
+void test_variate_service_handoff() {
+    holtsmark_variate_service service(1, 0, 1, 9, 1);
+
+    vector<double> x(50 * holtsmark_variate_block_size);
+    service[0].fill(x);
+
+    check(x == variate_service_expected(9, 0, x.size(), 0, 1), "single block handoff");
+    check(service.memory_bytes() == sizeof(holtsmark_variate_block), "memory of one block");
+}
+
+// idle producers block instead of spinning
+void test_variate_service_idle() {
+    holtsmark_variate_service service(4, 0, 1, 0, 4, 2);
+
+    // let the producers fill every block
+    this_thread::sleep_for(chrono::milliseconds(100));
+
+    clock_t cpu0 = clock();
+    this_thread::sleep_for(chrono::milliseconds(300));
+    double cpu = (double)(clock() - cpu0) / CLOCKS_PER_SEC;
+
+    check(cpu < 0.05, "cpu time while idle " + to_string(cpu) + " s");
+    check(service[3].next() == variate_service_expected(0, 3, 1, 0, 1)[0], "still serves");
+}
+
+void test_variate_service_arguments() {
+    bool thrown = false;
+    try {
+        holtsmark_variate_service service(2, 0, 1, 0, 0);
+    }
+    catch (const invalid_argument&) {
+        thrown = true;
+    }
+    check(thrown, "zero blocks per consumer refused");
+
+    holtsmark_variate_service none(0);
+    check(none.consumers() == 0 && none.memory_bytes() == 0, "no consumers");
+}
+
+void test_variate_service() {
+    test_variate_service_streams();
+    test_variate_service_handoff();
+    test_variate_service_idle();
+    test_variate_service_arguments();
+}
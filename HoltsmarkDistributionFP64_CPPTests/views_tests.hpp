@@ -0,0 +1,92 @@
+// Author: T.Yoshimura
+// Github: https://github.com/tk-yoshimura
+// Original Code: https://github.com/tk-yoshimura/HoltsmarkDistributionFP64
+// C++20 implement
+
+#pragma once
+
+#include "holtsmark_test.hpp"
+#include "holtsmark_views.hpp"
+
+#include <random>
+#include <vector>
+
+// the views yield exactly the batch results, across chunk boundaries and for partial chunks
+void test_views_functions() {
+    vector<double> x(150);
+    for (size_t i = 0; i < x.size(); i++) {
+        x[i] = -30 + 0.4 * i;
+    }
+
+    vector<double> pdf(x.size()), cdf(x.size()), ccdf(x.size());
+    holtsmark_pdf_batch(x, pdf, 1, 2);
+    holtsmark_cdf_batch(x, cdf, 0, 1, false);
+    holtsmark_cdf_batch(x, ccdf, 0.5, 3, true);
+
+    vector<double> pdf_view, cdf_view, ccdf_view;
+    for (double y : x | holtsmark::views::pdf(1, 2)) {
+        pdf_view.push_back(y);
+    }
+    for (double y : x | holtsmark::views::cdf) {
+        cdf_view.push_back(y);
+    }
+    for (double y : x | holtsmark::views::cdf(0.5, 3, true)) {
+        ccdf_view.push_back(y);
+    }
+
+    check(pdf_view == pdf, "pdf view");
+    check(cdf_view == cdf, "cdf view");
+    check(ccdf_view == ccdf, "complementary cdf view");
+
+    vector<double> p = { 0.01, 0.25, 0.5, 0.75, 0.99 }, q(p.size()), q_view;
+    holtsmark_quantile_batch(p, q, 0, 1, false);
+    for (double y : p | holtsmark::views::quantile) {
+        q_view.push_back(y);
+    }
+    check(q_view == q, "quantile view");
+
+    vector<double> none;
+    size_t count = 0;
+    for (double y : none | holtsmark::views::pdf) {
+        count += (y >= 0) ? 1 : 0;
+    }
+    check(count == 0, "empty range");
+}
+
+// the base range is consumed one chunk at a time, and the views compose with std::views
+void test_views_lazy() {
+    size_t pulled = 0;
+    auto base = std::views::iota(0, 1000) | std::views::transform([&](int i) { pulled++; return i * 0.01; });
+
+    double s = 0;
+    for (double y : base | holtsmark::views::pdf | std::views::take(3)) {
+        s += y;
+    }
+
+    check(pulled == holtsmark::view_chunk, "one chunk pulled, got " + to_string(pulled));
+    check_near(s, holtsmark_pdf(0) + holtsmark_pdf(0.01) + holtsmark_pdf(0.02), 1e-15, "sum of the first three");
+}
+
+// the sample view draws the same variates as chunkwise holtsmark_sample_batch calls
+void test_views_sample() {
+    mt19937_64 engine(3), reference(3);
+
+    vector<double> expected(4 * holtsmark::view_chunk);
+    for (size_t k = 0; k < 4; k++) {
+        holtsmark_sample_batch(reference, span<double>(expected).subspan(k * holtsmark::view_chunk, holtsmark::view_chunk), 1, 2);
+    }
+
+    vector<double> samples;
+    for (double y : holtsmark::views::sample(engine, 1, 2) | std::views::take(200)) {
+        samples.push_back(y);
+    }
+
+    check(samples.size() == 200, "take 200");
+    check(equal(samples.begin(), samples.end(), expected.begin()), "same variates as the batch");
+}
+
+void test_views() {
+    test_views_functions();
+    test_views_lazy();
+    test_views_sample();
+}